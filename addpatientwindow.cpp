@@ -1,5 +1,6 @@
 #include "addpatientwindow.h"
-#include "dashboardwindow.h"
+#include "navigator.h"
+#include "trace.h"
 #include <QLabel>
 #include <QLineEdit>
 #include <QComboBox>
@@ -20,25 +21,21 @@
     setupUi();
 }*/
 
-AddPatientWindow::AddPatientWindow(Backend* backendPtr, QWidget *parent)
-    : QMainWindow(parent), backend(backendPtr)  // assign pointer
+AddPatientWindow::AddPatientWindow(Backend* backendPtr, Navigator* navigatorPtr, QWidget *parent)
+    : QMainWindow(parent), backend(backendPtr), navigator(navigatorPtr)  // assign pointers
 {
     setupUi();
 }
 
 void AddPatientWindow::setupUi()
 {
+    TRACE_SPAN("ui", "AddPatientWindow::setupUi");
     // Central widget
     QWidget *central = new QWidget(this);
     setCentralWidget(central);
 
     // Match dashboard's gradient background
-    central->setStyleSheet(R"(
-        QWidget {
-            background: qlineargradient(spread:pad, x1:0, y1:0, x2:1, y2:1,
-                        stop:0 #f3f7fc, stop:1 #d6e6f5);
-        }
-    )");
+    central->setObjectName("screen");
 
     // Main layout - centered with proper margins
     QVBoxLayout *mainLayout = new QVBoxLayout(central);
@@ -48,13 +45,7 @@ void AddPatientWindow::setupUi()
     // Form card container - clean white card
     QFrame *formCard = new QFrame;
     formCard->setFixedWidth(550);
-    formCard->setStyleSheet(R"(
-        QFrame {
-            background-color: #ffffff;
-            border: 1px solid #cfd9e6;
-            border-radius: 12px;
-        }
-    )");
+    formCard->setObjectName("card");
 
     QVBoxLayout *cardLayout = new QVBoxLayout(formCard);
     cardLayout->setContentsMargins(40, 45, 40, 45);
@@ -62,15 +53,7 @@ void AddPatientWindow::setupUi()
 
     // Header section
     QLabel *titleLabel = new QLabel("Add New Patient");
-    titleLabel->setStyleSheet(R"(
-        font-size: 24px;
-        font-weight: bold;
-        color: #1f2f45;
-        background: transparent;
-        border: none;
-        margin-bottom: 15px;
-
-    )");
+    titleLabel->setObjectName("title");
     titleLabel->setAlignment(Qt::AlignLeft);
     cardLayout->addWidget(titleLabel);
 
@@ -78,49 +61,18 @@ void AddPatientWindow::setupUi()
     // Divider line
     QFrame *line = new QFrame;
     line->setFrameShape(QFrame::HLine);
-    line->setStyleSheet("color: #cfd9e6; margin: 20px 0;");
+    line->setObjectName("separator");
     cardLayout->addWidget(line);
 
     // Form section with consistent spacing
     QVBoxLayout *formSection = new QVBoxLayout;
     formSection->setSpacing(18);
 
-    // Common input style matching dashboard theme
-    QString inputStyle = R"(
-        QLineEdit, QComboBox, QSpinBox, QDateEdit {
-            padding: 10px 12px;
-            border: 1px solid #cfd9e6;
-            border-radius: 6px;
-            font-size: 11pt;
-            background-color: #ffffff;
-            color: #1f2f45;
-        }
-        QLineEdit:focus, QComboBox:focus, QSpinBox:focus, QDateEdit:focus {
-            border: 1px solid #2b7de9;
-            background-color: #f8fafc;
-        }
-        QTextEdit {
-            padding: 10px 12px;
-            border: 1px solid #cfd9e6;
-            border-radius: 6px;
-            font-size: 11pt;
-            background-color: #ffffff;
-            color: #1f2f45;
-        }
-        QTextEdit:focus {
-            border: 1px solid #2b7de9;
-            background-color: #f8fafc;
-        }
-    )";
-
-    QString labelStyle = "font-size: 11pt; color: #1f2f45; font-weight: 500; background: transparent; border: none; margin-bottom: 8px;";
-
     // Name field
     QLabel *nameLabel = new QLabel("Patient Name");
-    nameLabel->setStyleSheet(labelStyle);
+    nameLabel->setObjectName("fieldLabel");
     nameEdit = new QLineEdit;
     nameEdit->setPlaceholderText("Enter full name");
-    nameEdit->setStyleSheet(inputStyle);
     formSection->addWidget(nameLabel);
     formSection->addWidget(nameEdit);
 
@@ -132,10 +84,9 @@ void AddPatientWindow::setupUi()
     QVBoxLayout *genderCol = new QVBoxLayout;
     genderCol->setSpacing(8);
     QLabel *genderLabel = new QLabel("Gender");
-    genderLabel->setStyleSheet(labelStyle);
+    genderLabel->setObjectName("fieldLabel");
     genderCombo = new QComboBox;
     genderCombo->addItems({"Select", "Male", "Female", "Other"});
-    genderCombo->setStyleSheet(inputStyle);
     genderCol->addWidget(genderLabel);
     genderCol->addWidget(genderCombo);
 
@@ -143,11 +94,10 @@ void AddPatientWindow::setupUi()
     QVBoxLayout *ageCol = new QVBoxLayout;
     ageCol->setSpacing(8);
     QLabel *ageLabel = new QLabel("Age");
-    ageLabel->setStyleSheet(labelStyle);
+    ageLabel->setObjectName("fieldLabel");
     ageSpin = new QSpinBox;
     ageSpin->setRange(1, 150);
     ageSpin->setValue(1);
-    ageSpin->setStyleSheet(inputStyle);
     ageCol->addWidget(ageLabel);
     ageCol->addWidget(ageSpin);
 
@@ -157,22 +107,20 @@ void AddPatientWindow::setupUi()
 
     // Visit date field
     QLabel *dateLabel = new QLabel("Date of Visit");
-    dateLabel->setStyleSheet(labelStyle);
+    dateLabel->setObjectName("fieldLabel");
     visitDateEdit = new QDateEdit;
     visitDateEdit->setCalendarPopup(true);
     visitDateEdit->setDate(QDate::currentDate());
     visitDateEdit->setDisplayFormat("dddd, MMMM d, yyyy");
-    visitDateEdit->setStyleSheet(inputStyle);
     formSection->addWidget(dateLabel);
     formSection->addWidget(visitDateEdit);
 
     // Notes field
     QLabel *notesLabel = new QLabel("Additional Notes (Optional)");
-    notesLabel->setStyleSheet(labelStyle);
+    notesLabel->setObjectName("fieldLabel");
     notesEdit = new QTextEdit;
     notesEdit->setPlaceholderText("Any additional information...");
     notesEdit->setMaximumHeight(90);
-    notesEdit->setStyleSheet(inputStyle);
     formSection->addWidget(notesLabel);
     formSection->addWidget(notesEdit);
 
@@ -186,38 +134,12 @@ void AddPatientWindow::setupUi()
     // Cancel button - matching dashboard sidebar style
     QPushButton *cancelBtn = new QPushButton("Cancel");
     cancelBtn->setFixedHeight(42);
-    cancelBtn->setStyleSheet(R"(
-        QPushButton {
-            background-color: #e8ecef;
-            color: #1f2f45;
-            border: none;
-            border-radius: 6px;
-            padding: 0 24px;
-            font-size: 11pt;
-            font-weight: 500;
-        }
-        QPushButton:hover {
-            background-color: #d6dce2;
-        }
-    )");
+    cancelBtn->setObjectName("secondaryButton");
 
     // Add Patient button - matching dashboard blue theme
     QPushButton *addBtn = new QPushButton("Add Patient");
     addBtn->setFixedHeight(42);
-    addBtn->setStyleSheet(R"(
-        QPushButton {
-            background-color: #2b7de9;
-            color: white;
-            border: none;
-            border-radius: 6px;
-            padding: 0 24px;
-            font-size: 11pt;
-            font-weight: 500;
-        }
-        QPushButton:hover {
-            background-color: #256dd1;
-        }
-    )");
+    addBtn->setObjectName("primaryButton");
 
     buttonLayout->addStretch();
     buttonLayout->addWidget(cancelBtn);
@@ -239,6 +161,7 @@ void AddPatientWindow::setupUi()
 
 void AddPatientWindow::onAddPatientClicked()
 {
+    TRACE_SPAN("ui", "AddPatientWindow::onAddPatientClicked");
     QString name = nameEdit->text().trimmed();
     QString gender = genderCombo->currentText();
     int age = ageSpin->value();
@@ -276,7 +199,7 @@ void AddPatientWindow::onAddPatientClicked()
     }
 
     // Add to recent visits queue
-    backend->addRecentVisit(newPatient.id, newPatient.name);
+    backend->addRecentVisit(newPatient.id);
 
     // Success message
     QMessageBox::information(this, "Success",
@@ -284,7 +207,13 @@ void AddPatientWindow::onAddPatientClicked()
                                  .arg(QString::fromStdString(newPatient.name))
                                  .arg(newPatient.id));
 
-    // Clear form
+    resetForm();
+}
+
+// Empty form, ready for the next patient (also run each time the screen is shown)
+void AddPatientWindow::resetForm()
+{
+    TRACE_SPAN("ui", "AddPatientWindow::resetForm");
     nameEdit->clear();
     genderCombo->setCurrentIndex(0);
     ageSpin->setValue(1);
@@ -296,8 +225,5 @@ void AddPatientWindow::onAddPatientClicked()
 
 void AddPatientWindow::onCancelClicked()
 {
-    DashboardWindow *dashboard = new DashboardWindow(backend, nullptr);
-    dashboard->setAttribute(Qt::WA_DeleteOnClose);
-    dashboard->show();
-    this->close();
+    navigator->go(Screen::Dashboard);
 }
@@ -2,6 +2,7 @@
 #include <QMainWindow>
 #include "backend.h"
 
+class Navigator;
 class QLineEdit;
 class QComboBox;
 class QSpinBox;
@@ -13,7 +14,8 @@ class AddPatientWindow : public QMainWindow
 {
     Q_OBJECT
 public:
-    explicit AddPatientWindow(Backend* backend, QWidget *parent = nullptr);
+    explicit AddPatientWindow(Backend* backend, Navigator* navigator, QWidget *parent = nullptr);
+    void resetForm();
 
 private slots:
     void onAddPatientClicked();
@@ -29,6 +31,7 @@ private:
     QDateEdit *visitDateEdit;
     QTextEdit *notesEdit;
     Backend* backend;
+    Navigator* navigator;
 };
 
 
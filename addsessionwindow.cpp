@@ -1,6 +1,8 @@
 #include "addsessionwindow.h"
-#include "dashboardwindow.h"
+#include "navigator.h"
 #include "backend.h"
+#include "theme.h"
+#include "trace.h"
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QLabel>
@@ -11,27 +13,61 @@
 #include <QFileDialog>
 #include <QMessageBox>
 #include <QSpacerItem>
+#include <QListWidget>
+#include <QTimer>
+#include <QProgressBar>
+#include <QThreadPool>
+#include <QCoreApplication>
+#include <QtConcurrent/QtConcurrentRun>
+
+// Type-ahead: wait this long after the last keystroke before searching,
+// and show at most this many suggestions
+static const int TYPE_AHEAD_DELAY_MS = 80;
+static const size_t MAX_SUGGESTIONS = 8;
+
+// How often the recording progress is refreshed while a file is stored
+static const int INGEST_POLL_MS = 100;
+
+// Recordings are copied one at a time on their own thread, so a long copy
+// never holds up type-ahead searches on the global pool
+static QThreadPool* recordingPool()
+{
+    static QThreadPool* pool = [] {
+        QThreadPool* p = new QThreadPool(QCoreApplication::instance());
+        p->setMaxThreadCount(1);
+        return p;
+    }();
+    return pool;
+}
 
-
-AddSessionWindow::AddSessionWindow(Backend* backendPtr, QWidget *parent)
-    : QMainWindow(parent), backend(backendPtr), currentPatientID(-1)  // Initialize here
+AddSessionWindow::AddSessionWindow(Backend* backendPtr, Navigator* navigatorPtr, QWidget *parent)
+    : QMainWindow(parent), backend(backendPtr), navigator(navigatorPtr), currentPatientID(-1),  // Initialize here
+      typeAheadGeneration(0)
 {
     setupUi();
 }
 
+AddSessionWindow::~AddSessionWindow()
+{
+    // A search still running on the pool reads the backend, which main() destroys
+    // after the windows: stop it early and wait for it to return
+    cancelTypeAhead();
+    typeAheadWatcher->waitForFinished();
+
+    // A copy in progress only touches its own progress block; stop it and
+    // let the store drop the partial file
+    cancelIngest();
+}
+
 
 void AddSessionWindow::setupUi()
 {
+    TRACE_SPAN("ui", "AddSessionWindow::setupUi");
     QWidget *central = new QWidget(this);
     setCentralWidget(central);
 
     // Background (same as theme)
-    central->setStyleSheet(R"(
-        QWidget {
-            background: qlineargradient(spread:pad, x1:0, y1:0, x2:1, y2:1,
-                        stop:0 #f3f7fc, stop:1 #d6e6f5);
-        }
-    )");
+    central->setObjectName("screen");
 
     QVBoxLayout *mainLayout = new QVBoxLayout(central);
     mainLayout->setAlignment(Qt::AlignCenter);
@@ -39,13 +75,7 @@ void AddSessionWindow::setupUi()
     // --- Main Card Container ---
     QFrame *formCard = new QFrame;
     formCard->setFixedWidth(550);
-    formCard->setStyleSheet(R"(
-        QFrame {
-            background-color: #ffffff;
-            border: 1px solid #cfd9e6;
-            border-radius: 12px;
-        }
-    )");
+    formCard->setObjectName("card");
 
     QVBoxLayout *cardLayout = new QVBoxLayout(formCard);
     cardLayout->setContentsMargins(40, 45, 40, 45);
@@ -53,137 +83,77 @@ void AddSessionWindow::setupUi()
 
     // --- Title ---
     QLabel *titleLabel = new QLabel("Add New Session");
-    titleLabel->setStyleSheet(R"(
-        font-size: 24px;
-        font-weight: bold;
-        color: #1f2f45;
-        background: transparent;
-        border: none;
-        margin-bottom: 5px;
-    )");
+    titleLabel->setObjectName("title");
     titleLabel->setAlignment(Qt::AlignLeft);
     cardLayout->addWidget(titleLabel);
 
 
-    // --- Styles ---
-    QString inputStyle = R"(
-        QLineEdit, QTextEdit {
-            padding: 10px 12px;
-            border: 1px solid #cfd9e6;
-            border-radius: 6px;
-            font-size: 11pt;
-            color: #1f2f45;
-            background-color: #ffffff;
-        }
-        QLineEdit:focus, QTextEdit:focus {
-            border: 1px solid #2b7de9;
-            background-color: #f8fafc;
-        }
-    )";
-
-    QString labelStyle = R"(
-        font-size: 11pt;
-        color: #1f2f45;
-        font-weight: 500;
-        background: transparent;
-        border: none;
-        margin-bottom: 6px;
-    )";
-
     // --- Search Section ---
     QLabel *searchLabel = new QLabel("Search Patient");
-    searchLabel->setStyleSheet(labelStyle);
+    searchLabel->setObjectName("fieldLabel");
     cardLayout->addWidget(searchLabel);
 
     QHBoxLayout *searchLayout = new QHBoxLayout;
     searchEdit = new QLineEdit;
     searchEdit->setPlaceholderText("Enter patient name or ID");
-    searchEdit->setStyleSheet(inputStyle);
 
     searchBtn = new QPushButton("Search");
     searchBtn->setFixedWidth(100);
-    searchBtn->setStyleSheet(R"(
-        QPushButton {
-            background-color: #2b7de9;
-            color: white;
-            border: none;
-            border-radius: 6px;
-            font-size: 10.5pt;
-            font-weight: 500;
-            padding: 8px;
-        }
-        QPushButton:hover {
-            background-color: #256dd1;
-        }
-    )");
+    searchBtn->setObjectName("primaryButton");
+    searchBtn->setProperty("compact", true);
 
     searchLayout->addWidget(searchEdit);
     searchLayout->addWidget(searchBtn);
     cardLayout->addLayout(searchLayout);
 
+    // Type-ahead suggestions, shown while typing
+    suggestionList = new QListWidget;
+    suggestionList->setMaximumHeight(130);
+    suggestionList->setObjectName("suggestionList");
+    suggestionList->hide();
+    cardLayout->addWidget(suggestionList);
+
     patientResultLabel = new QLabel("No patient selected.");
-    patientResultLabel->setStyleSheet(R"(
-    QLabel {
-        color: #6b7c8c;
-        font-size: 10pt;
-        margin-top: 5px;
-        background: transparent;
-        border: none;
-    }
-)");
+    patientResultLabel->setObjectName("statusLabel");
     cardLayout->addWidget(patientResultLabel);
 
     // --- Session Info ---
     QLabel *sessionLabel = new QLabel("Session Number");
-    sessionLabel->setStyleSheet(labelStyle);
+    sessionLabel->setObjectName("fieldLabel");
     sessionNumberEdit = new QLineEdit;
     sessionNumberEdit->setReadOnly(true);
-    sessionNumberEdit->setStyleSheet(inputStyle);
     sessionNumberEdit->setText("—");
     cardLayout->addWidget(sessionLabel);
     cardLayout->addWidget(sessionNumberEdit);
 
     // --- Upload Recording ---
     QLabel *uploadLabel = new QLabel("Upload Session Recording");
-    uploadLabel->setStyleSheet(labelStyle);
+    uploadLabel->setObjectName("fieldLabel");
     QPushButton *uploadBtn = new QPushButton("Choose File");
-    uploadBtn->setStyleSheet(R"(
-        QPushButton {
-            background-color: #2b7de9;
-            color: white;
-            border: none;
-            border-radius: 6px;
-            padding: 8px 16px;
-            font-size: 10.5pt;
-            font-weight: 500;
-        }
-        QPushButton:hover {
-            background-color: #256dd1;
-        }
-    )");
+    uploadBtn->setObjectName("primaryButton");
+    uploadBtn->setProperty("compact", true);
 
     recordingFileLabel = new QLabel("No file selected.");
-    recordingFileLabel->setStyleSheet(R"(
-    QLabel {
-        color: #6b7c8c;
-        font-size: 10pt;
-        margin-top: 4px;
-        background: transparent;
-        border: none;
-    }
-)");
+    recordingFileLabel->setObjectName("statusLabel");
+
+    recordingProgress = new QProgressBar;
+    recordingProgress->setRange(0, 1000);
+    recordingProgress->setTextVisible(false);
+    recordingProgress->setFixedHeight(6);
+    recordingProgress->setObjectName("recordingProgress");
+    recordingProgress->hide();
 
     cardLayout->addWidget(uploadLabel);
     cardLayout->addWidget(uploadBtn);
     cardLayout->addWidget(recordingFileLabel);
+    cardLayout->addWidget(recordingProgress);
 
     // --- Notes Section ---
     QLabel *notesLabel = new QLabel("Session Notes (Optional)");
-    notesLabel->setStyleSheet(labelStyle);
+    notesLabel->setObjectName("fieldLabel");
     notesEdit = new QTextEdit;
     notesEdit->setPlaceholderText("Add any details about this session...");
     notesEdit->setMaximumHeight(100);
-    notesEdit->setStyleSheet(inputStyle);
     cardLayout->addWidget(notesLabel);
     cardLayout->addWidget(notesEdit);
 
@@ -193,37 +163,11 @@ void AddSessionWindow::setupUi()
 
     QPushButton *cancelBtn = new QPushButton("Cancel");
     cancelBtn->setFixedHeight(42);
-    cancelBtn->setStyleSheet(R"(
-        QPushButton {
-            background-color: #e8ecef;
-            color: #1f2f45;
-            border: none;
-            border-radius: 6px;
-            padding: 0 24px;
-            font-size: 11pt;
-            font-weight: 500;
-        }
-        QPushButton:hover {
-            background-color: #d6dce2;
-        }
-    )");
+    cancelBtn->setObjectName("secondaryButton");
 
     QPushButton *saveBtn = new QPushButton("Save Session");
     saveBtn->setFixedHeight(42);
-    saveBtn->setStyleSheet(R"(
-        QPushButton {
-            background-color: #2b7de9;
-            color: white;
-            border: none;
-            border-radius: 6px;
-            padding: 0 24px;
-            font-size: 11pt;
-            font-weight: 500;
-        }
-        QPushButton:hover {
-            background-color: #256dd1;
-        }
-    )");
+    saveBtn->setObjectName("primaryButton");
 
     buttonLayout->addStretch();
     buttonLayout->addWidget(cancelBtn);
@@ -232,9 +176,28 @@ void AddSessionWindow::setupUi()
 
     mainLayout->addWidget(formCard);
 
+    // --- Type-ahead search ---
+    typeAheadTimer = new QTimer(this);
+    typeAheadTimer->setSingleShot(true);
+    typeAheadTimer->setInterval(TYPE_AHEAD_DELAY_MS);
+    typeAheadWatcher = new QFutureWatcher<TypeAheadResult>(this);
+
+    // --- Recording ingestion ---
+    ingestTimer = new QTimer(this);
+    ingestTimer->setInterval(INGEST_POLL_MS);
+    ingestWatcher = new QFutureWatcher<IngestResult>(this);
+
     // --- Connections ---
     connect(searchBtn, &QPushButton::clicked, this, &AddSessionWindow::onSearchPatientClicked);
+    connect(searchEdit, &QLineEdit::returnPressed, this, &AddSessionWindow::onSearchPatientClicked);
+    connect(searchEdit, &QLineEdit::textChanged, this, &AddSessionWindow::onSearchTextChanged);
+    connect(typeAheadTimer, &QTimer::timeout, this, &AddSessionWindow::onTypeAheadTimeout);
+    connect(typeAheadWatcher, &QFutureWatcher<TypeAheadResult>::finished,
+            this, &AddSessionWindow::onTypeAheadFinished);
+    connect(suggestionList, &QListWidget::itemClicked, this, &AddSessionWindow::onSuggestionClicked);
     connect(uploadBtn, &QPushButton::clicked, this, &AddSessionWindow::onUploadRecordingClicked);
+    connect(ingestTimer, &QTimer::timeout, this, &AddSessionWindow::onIngestTick);
+    connect(ingestWatcher, &QFutureWatcher<IngestResult>::finished, this, &AddSessionWindow::onIngestFinished);
     connect(saveBtn, &QPushButton::clicked, this, &AddSessionWindow::onSaveSessionClicked);
     connect(cancelBtn, &QPushButton::clicked, this, &AddSessionWindow::onCancelClicked);
 
@@ -247,6 +210,7 @@ void AddSessionWindow::setupUi()
 
 void AddSessionWindow::onSearchPatientClicked()
 {
+    TRACE_SPAN("ui", "AddSessionWindow::onSearchPatientClicked");
     QString searchText = searchEdit->text().trimmed();
 
     if (searchText.isEmpty()) {
@@ -254,9 +218,17 @@ void AddSessionWindow::onSearchPatientClicked()
         return;
     }
 
+    // An explicit search replaces whatever the type-ahead is doing
+    typeAheadTimer->stop();
+    cancelTypeAhead();
+    suggestionList->hide();
+
     // Search in backend (by ID or name)
-    Patient* found = backend->searchPatient(searchText.toStdString());
+    showSelectedPatient(backend->searchPatient(searchText.toStdString()));
+}
 
+void AddSessionWindow::showSelectedPatient(Patient* found)
+{
     if (found) {
         currentPatientID = found->id;  // Store the patient ID
 
@@ -266,65 +238,197 @@ void AddSessionWindow::onSearchPatientClicked()
                 .arg(QString::fromStdString(found->name))
                 .arg(found->id)
             );
-        patientResultLabel->setStyleSheet(R"(
-            QLabel {
-                color: #2b7de9;
-                font-size: 10pt;
-                font-weight: 500;
-                margin-top: 5px;
-                background: transparent;
-                border: none;
-            }
-        )");
-
-        // Show next session number (visit_count + 1)
-        sessionNumberEdit->setText(QString::number(found->visit_count + 1));
+        Theme::setState(patientResultLabel, "found");
+
+        // Show next session number from the patient's own session history
+        sessionNumberEdit->setText(QString::number(backend->getSessionCount(found->id) + 1));
 
     } else {
         currentPatientID = -1;
         patientResultLabel->setText("✗ Patient not found. Please check the name or ID.");
-        patientResultLabel->setStyleSheet(R"(
-            QLabel {
-                color: #dc3545;
-                font-size: 10pt;
-                font-weight: 500;
-                margin-top: 5px;
-                background: transparent;
-                border: none;
-            }
-        )");
+        Theme::setState(patientResultLabel, "missing");
         sessionNumberEdit->setText("—");
     }
 }
 
+// --- Type-ahead search ---
+
+// Every keystroke restarts the debounce timer and drops any answer still
+// on its way for the old text; nothing is searched yet
+void AddSessionWindow::onSearchTextChanged()
+{
+    cancelTypeAhead();
+    if (searchEdit->text().trimmed().isEmpty()) {
+        typeAheadTimer->stop();
+        suggestionList->clear();
+        suggestionList->hide();
+        return;
+    }
+    typeAheadTimer->start();
+}
+
+// Typing paused: cancel the stale query and search on the thread pool
+void AddSessionWindow::onTypeAheadTimeout()
+{
+    QString query = searchEdit->text().trimmed();
+    cancelTypeAhead();
+    if (query.isEmpty()) return;
+
+    auto cancel = std::make_shared<std::atomic<bool>>(false);
+    typeAheadCancel = cancel;
+    quint64 generation = ++typeAheadGeneration;
+
+    Backend* backendPtr = backend;
+    std::string term = query.toStdString();
+
+    typeAheadWatcher->setFuture(QtConcurrent::run([backendPtr, term, cancel, generation]() {
+        TypeAheadResult result{generation, {}};
+        for (Patient* p : backendPtr->searchPatients(term, MAX_SUGGESTIONS, cancel.get())) {
+            result.matches.append(PatientMatch{p->id, QString::fromStdString(p->name)});
+        }
+        return result;
+    }));
+}
+
+void AddSessionWindow::onTypeAheadFinished()
+{
+    TRACE_SPAN("ui", "AddSessionWindow::onTypeAheadFinished");
+    TypeAheadResult result = typeAheadWatcher->result();
+
+    // Answer to an older keystroke: a newer search is on its way
+    if (result.generation != typeAheadGeneration) return;
+
+    suggestionList->clear();
+    for (const PatientMatch& match : result.matches) {
+        QListWidgetItem* item = new QListWidgetItem(
+            QString("%1 (ID: %2)").arg(match.name).arg(match.id));
+        item->setData(Qt::UserRole, match.id);
+        suggestionList->addItem(item);
+    }
+    suggestionList->setVisible(!result.matches.isEmpty());
+}
+
+void AddSessionWindow::onSuggestionClicked(QListWidgetItem* item)
+{
+    showSelectedPatient(backend->getPatientByID(item->data(Qt::UserRole).toInt()));
+    suggestionList->hide();
+}
+
+// Stop the running search and make its result stale, so
+// onTypeAheadFinished() ignores it even if it already finished
+void AddSessionWindow::cancelTypeAhead()
+{
+    ++typeAheadGeneration;
+    if (typeAheadCancel) {
+        typeAheadCancel->store(true, std::memory_order_relaxed);
+        typeAheadCancel.reset();
+    }
+}
+
 void AddSessionWindow::onUploadRecordingClicked()
 {
     QString filePath = QFileDialog::getOpenFileName(this, "Select Session Recording", "",
                                                     "Audio/Video Files (*.mp3 *.wav *.mp4 *.mkv);;All Files (*)");
-    if (!filePath.isEmpty()) {
-        selectedFilePath = filePath;
-        recordingFileLabel->setText("Selected: " + QFileInfo(filePath).fileName());
+    if (filePath.isEmpty()) return;
+
+    // A newer choice replaces whatever was being stored
+    cancelIngest();
+    selectedFilePath = filePath;
+    recordingHash.clear();
+    recordingFileLabel->setText("Storing " + QFileInfo(filePath).fileName() + "...");
+    recordingProgress->setValue(0);
+    recordingProgress->show();
+
+    auto progress = std::make_shared<IngestProgress>();
+    ingestProgress = progress;
+    RecordingStore store = recordingStore;
+    ingestClock.start();
+    ingestTimer->start();
+    ingestWatcher->setFuture(QtConcurrent::run(recordingPool(), [store, filePath, progress]() {
+        return store.ingest(filePath, progress.get());
+    }));
+}
+
+// Refresh the progress bar and throughput from the worker's counters
+void AddSessionWindow::onIngestTick()
+{
+    if (!ingestProgress) return;
+
+    const qint64 done = ingestProgress->bytesDone.load();
+    const qint64 total = ingestProgress->bytesTotal.load();
+    const double seconds = qMax<qint64>(1, ingestClock.elapsed()) / 1000.0;
+    const double mibPerSecond = done / (1024.0 * 1024.0) / seconds;
+
+    if (total > 0) recordingProgress->setValue(static_cast<int>(done * 1000 / total));
+    recordingFileLabel->setText(QString("Storing %1... %2 of %3 MB (%4 MB/s)")
+                                    .arg(QFileInfo(selectedFilePath).fileName())
+                                    .arg(done / (1024 * 1024))
+                                    .arg(total / (1024 * 1024))
+                                    .arg(mibPerSecond, 0, 'f', 0));
+}
+
+void AddSessionWindow::onIngestFinished()
+{
+    TRACE_SPAN("ui", "AddSessionWindow::onIngestFinished");
+    // Nothing being stored any more (cancelled, or replaced by a newer file)
+    if (!ingestProgress) return;
+
+    IngestResult result = ingestWatcher->result();
+    ingestTimer->stop();
+    ingestProgress.reset();
+    recordingProgress->hide();
+
+    QString fileName = QFileInfo(selectedFilePath).fileName();
+    if (!result.ok) {
+        recordingFileLabel->setText("Could not store " + fileName + ": " + result.error);
+        return;
+    }
+
+    recordingHash = result.hash;
+    recordingFileLabel->setText(QString("Stored: %1 (%2 MB at %3 MB/s%4)")
+                                    .arg(fileName)
+                                    .arg(result.bytes / (1024 * 1024))
+                                    .arg(result.mibPerSecond, 0, 'f', 0)
+                                    .arg(result.duplicate ? ", already on file" : ""));
+}
+
+void AddSessionWindow::cancelIngest()
+{
+    ingestTimer->stop();
+    if (ingestProgress) {
+        ingestProgress->cancelled = true;
+        ingestProgress.reset();
     }
 }
 
 void AddSessionWindow::onSaveSessionClicked()
 {
+    TRACE_SPAN("ui", "AddSessionWindow::onSaveSessionClicked");
     // Validate patient is selected
     if (currentPatientID == -1) {
         QMessageBox::warning(this, "Error", "Please search and select a patient first.");
         return;
     }
 
+    // The recording must be in the store before the session can point at it
+    if (ingestProgress) {
+        QMessageBox::information(this, "Please Wait", "The recording is still being stored.");
+        return;
+    }
+    if (!selectedFilePath.isEmpty() && recordingHash.isEmpty()) {
+        auto answer = QMessageBox::question(this, "Recording Not Stored",
+                                            "The recording could not be stored. Save the session without it?");
+        if (answer != QMessageBox::Yes) return;
+    }
+
     QString notes = notesEdit->toPlainText().trimmed();
 
     // Create session in backend
-    Session newSession = backend->addSession(currentPatientID, notes.toStdString());
+    Session newSession = backend->addSession(currentPatientID, notes.toStdString(),
+                                             recordingHash.toStdString());
 
-    // Get patient for recent visits update
-    Patient* p = backend->getPatientByID(currentPatientID);
-    if (p) {
-        backend->addRecentVisit(p->id, p->name);
-    }
+    // Update recent visits
+    backend->addRecentVisit(currentPatientID);
 
     // Success message
     QMessageBox::information(this, "Success",
@@ -332,19 +436,41 @@ void AddSessionWindow::onSaveSessionClicked()
                                  .arg(newSession.session_id)
                                  .arg(currentPatientID));
 
-    // Return to dashboard with fresh data
-    DashboardWindow *dashboard = new DashboardWindow(backend, nullptr);
-    dashboard->setAttribute(Qt::WA_DeleteOnClose);
-    dashboard->show();
-    this->close();
+    // Return to dashboard; its lists already show the new session
+    resetForm();
+    navigator->go(Screen::Dashboard);
 }
 
 
 void AddSessionWindow::onCancelClicked()
 {
-    DashboardWindow *dashboard = new DashboardWindow(backend, nullptr);
-    dashboard->setAttribute(Qt::WA_DeleteOnClose);
-    dashboard->show();
-    this->close();
+    resetForm();
+    navigator->go(Screen::Dashboard);
+}
+
+void AddSessionWindow::resetForm()
+{
+    TRACE_SPAN("ui", "AddSessionWindow::resetForm");
+    typeAheadTimer->stop();
+    cancelTypeAhead();
+    cancelIngest();
+
+    // Clearing the search box would start a type-ahead; nothing to search for
+    searchEdit->blockSignals(true);
+    searchEdit->clear();
+    searchEdit->blockSignals(false);
+    suggestionList->clear();
+    suggestionList->hide();
+
+    currentPatientID = -1;
+    patientResultLabel->setText("No patient selected.");
+    Theme::setState(patientResultLabel, "");
+    sessionNumberEdit->setText("—");
+
+    selectedFilePath.clear();
+    recordingHash.clear();
+    recordingFileLabel->setText("No file selected.");
+    recordingProgress->hide();
+    notesEdit->clear();
 }
 
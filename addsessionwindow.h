@@ -1,38 +1,93 @@
 #pragma once
 #include <QMainWindow>
+#include <QVector>
+#include <QFutureWatcher>
+#include <QElapsedTimer>
+#include <atomic>
+#include <memory>
 #include "backend.h"
+#include "recordingstore.h"
 
+class Navigator;
 class QLineEdit;
 class QTextEdit;
 class QPushButton;
 class QLabel;
+class QListWidget;
+class QListWidgetItem;
+class QTimer;
+class QProgressBar;
+
+// One type-ahead suggestion, copied out of the backend on the worker thread
+struct PatientMatch {
+    int id;
+    QString name;
+};
+
+// Result of one background search, tagged with the keystroke it answers
+struct TypeAheadResult {
+    quint64 generation;
+    QVector<PatientMatch> matches;
+};
 
 class AddSessionWindow : public QMainWindow
 {
     Q_OBJECT
 public:
-    explicit AddSessionWindow(Backend* backendPtr, QWidget* parent = nullptr);
+    explicit AddSessionWindow(Backend* backendPtr, Navigator* navigatorPtr, QWidget* parent = nullptr);
+    ~AddSessionWindow() override;
+
+    // Back to an empty form; drops any search or recording copy in flight
+    void resetForm();
 
 private slots:
     void onSearchPatientClicked();
+    void onSearchTextChanged();
+    void onTypeAheadTimeout();
+    void onTypeAheadFinished();
+    void onSuggestionClicked(QListWidgetItem* item);
     void onUploadRecordingClicked();
+    void onIngestTick();
+    void onIngestFinished();
     void onSaveSessionClicked();
     void onCancelClicked();
 
 private:
     void setupUi();
+    void showSelectedPatient(Patient* found);
+    void cancelTypeAhead();
+    void cancelIngest();
 
     // Widgets
     QLineEdit *searchEdit;
     QPushButton *searchBtn;
+    QListWidget *suggestionList;
     QLabel *patientResultLabel;
     QLineEdit *sessionNumberEdit;
     QLabel *recordingFileLabel;
+    QProgressBar *recordingProgress;
     QTextEdit *notesEdit;
 
     QString selectedFilePath;
     Backend* backend;
+    Navigator* navigator;
     int currentPatientID;
+
+    // Type-ahead search: debounced, run on a worker thread, and only the
+    // answer to the latest keystroke is shown
+    QTimer *typeAheadTimer;
+    QFutureWatcher<TypeAheadResult> *typeAheadWatcher;
+    std::shared_ptr<std::atomic<bool>> typeAheadCancel;
+    quint64 typeAheadGeneration;
+
+    // Recording ingestion: copied into the recording store on a worker
+    // thread; the timer polls progress for the label and progress bar
+    RecordingStore recordingStore;
+    QTimer *ingestTimer;
+    QFutureWatcher<IngestResult> *ingestWatcher;
+    std::shared_ptr<IngestProgress> ingestProgress;
+    QElapsedTimer ingestClock;
+    QString recordingHash;   // set once the selected file is stored
 };
 
 
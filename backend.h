@@ -0,0 +1,253 @@
+#ifndef BACKEND_H
+#define BACKEND_H
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <atomic>
+#include <shared_mutex>
+#include "nameindex.h"
+#include "notesindex.h"
+#include "nameorder.h"
+#include "recencyorder.h"
+#include "visitranking.h"
+#include "recentvisits.h"
+#include "chunkedarena.h"
+#include "storeview.h"
+#include "journal.h"
+#include <iterator>
+#include <memory>
+
+// ================= PATIENT =================
+struct Patient {
+    int id;
+    std::string name;
+    std::string gender;
+    std::string birth_date;
+    int visit_count;
+};
+
+// ================= SESSION =================
+struct Session {
+    int session_id;
+    int patientID;
+    std::string date;
+    std::string notes;
+    std::string recording_hash;   // SHA-256 in the recording store; empty = none
+};
+
+// Linked list node for sessions. Nodes live in Backend's session arena,
+// which is the only copy of each session.
+struct SessionNode {
+    Session data;
+    SessionNode* next;            // next session in the clinic
+    SessionNode* nextOfPatient;   // next session of the same patient
+};
+
+// One patient's sessions, chained through SessionNode::nextOfPatient
+struct SessionChain {
+    SessionNode* first = nullptr;
+    SessionNode* last = nullptr;
+    int count = 0;
+};
+
+// Forward iterator over sessions that follows one of SessionNode's links:
+// &SessionNode::next walks the whole clinic, &SessionNode::nextOfPatient
+// walks one patient's history
+template <SessionNode* SessionNode::*Link>
+class SessionLinkIterator
+{
+public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = Session;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const Session*;
+    using reference = const Session&;
+
+    explicit SessionLinkIterator(const SessionNode* node = nullptr) : node(node) {}
+
+    reference operator*() const { return node->data; }
+    pointer operator->() const { return &node->data; }
+    SessionLinkIterator& operator++() { node = node->*Link; return *this; }
+    SessionLinkIterator operator++(int) { SessionLinkIterator old = *this; ++*this; return old; }
+    bool operator==(const SessionLinkIterator& other) const { return node == other.node; }
+    bool operator!=(const SessionLinkIterator& other) const { return node != other.node; }
+
+private:
+    const SessionNode* node;
+};
+
+// Orders patients can be listed in (see Backend::patientAt)
+enum class PatientOrder {
+    Registration,   // order they were added
+    Name,           // A-Z by case-folded name
+    RecentVisit     // latest session first, then patients never seen
+};
+
+// Told about every change made through Backend's public mutators, on the
+// thread that made it (the GUI thread), after the change is in place.
+// Journal replay and snapshot loads are not reported.
+class BackendObserver
+{
+public:
+    virtual ~BackendObserver() = default;
+
+    virtual void onPatientsAdded(int firstID, size_t count) = 0;   // IDs firstID .. firstID + count - 1
+    virtual void onSessionAdded(const Session& session) = 0;
+    virtual void onRecentVisitsChanged(int patientID) = 0;         // -1: the whole list may have changed
+};
+
+using PatientRange = Range<std::deque<Patient>::const_iterator>;
+using SessionRange = Range<SessionLinkIterator<&SessionNode::next>>;
+using PatientSessionRange = Range<SessionLinkIterator<&SessionNode::nextOfPatient>>;
+
+// ================= MAIN BACKEND CLASS =================
+// All mutations happen on the GUI thread. searchPatients() may also be
+// called from worker threads (type-ahead search); it shares patientMutex
+// with addPatient(), which is the only writer of the data it reads.
+class Backend
+{
+public:
+    Backend();
+
+    // ========== Patients ==========
+    Patient addPatient(const std::string& name, const std::string& gender, const std::string& birth_date);
+
+    // Bulk insert (see bulkimport.h): IDs are assigned in row order, the
+    // batch is logged with one fsync and each index is built once for the
+    // whole batch, across `threads` workers (0 = one per core).
+    // Returns the first ID assigned.
+    int addPatients(std::vector<Patient> rows, unsigned threads = 0);
+    Patient* getPatientByID(int id);                          // O(1) through the ID index
+    Patient* searchPatient(const std::string& searchTerm);    // best match, by ID (numeric) or name
+    std::vector<Patient*> searchPatients(const std::string& searchTerm, size_t limit = 0,
+                                         const std::atomic<bool>* cancelled = nullptr);  // all matches, ranked
+    std::vector<Patient> getAllPatients() const;                       // deep copy; prefer patients()
+    std::vector<Patient> getFrequentlyVisited() const;                 // everyone, most visits first
+    std::vector<const Patient*> getTopVisited(size_t k) const;         // top k with at least one visit, O(k)
+
+    // ========== Sessions ==========
+    Session addSession(int patientID, const std::string& notes, const std::string& recordingHash = std::string());
+    std::vector<Session> getAllSessions() const;              // deep copy; prefer sessions()
+    std::vector<Session> getAllSessionsLinkedList() const;    // deep copy; prefer sessions()
+
+    // Per-patient history, O(that patient's sessions). Session pointers
+    // stay valid for the Backend's lifetime.
+    std::vector<const Session*> getSessionsForPatient(int patientID) const;   // oldest first
+    const Session* getLastSession(int patientID) const;                       // nullptr if none
+    int getSessionCount(int patientID) const;
+
+    // Sessions whose notes match `query`, best match first (BM25). Words
+    // must all appear; "quoted words" must appear together; word* matches
+    // any word starting with it. See NotesIndex.
+    std::vector<const Session*> searchNotes(const std::string& query, size_t limit = 20) const;
+
+    // ========== Zero-copy views ==========
+    // Non-owning ranges straight over Backend storage, in insertion order.
+    // Pages are O(1) to open, so UI and export code can walk the data a
+    // screenful at a time without allocating.
+    size_t patientCount() const { return allPatients.size(); }
+    size_t sessionCount() const { return sessionArena.size(); }
+    const Patient& patientAt(size_t index) const { return allPatients[index]; }   // registration order
+
+    // ========== Sort orders ==========
+    // Name and last-visit orders are maintained by addPatient/addSession,
+    // so listing in either order or jumping to any row is O(log n) and
+    // never sorts. `row` must be below patientCount().
+    const Patient& patientAt(size_t row, PatientOrder order) const;
+    size_t rowOf(int patientID, PatientOrder order) const;   // patientCount() if unknown
+    PatientRange patients() const;
+    PatientRange patientsPage(size_t offset, size_t count) const;
+    SessionRange sessions() const;
+    SessionRange sessionsPage(size_t offset, size_t count) const;
+    PatientSessionRange sessionsOf(int patientID) const;       // oldest first
+
+    // ========== Recent Visits ==========
+    void addRecentVisit(int patientID);                 // a revisit moves the patient to the front
+    std::vector<int> getRecentVisits() const;           // patient IDs, most recent first
+    size_t recentVisitCount() const { return recentVisits.size(); }
+    void setRecentVisitCapacity(size_t capacity);
+
+    // Bumped by every change to patients, sessions or recent visits, so a
+    // screen coming back into view can tell whether it needs to reload
+    uint64_t revision() const { return revisionCount; }
+
+    // ========== Change notification ==========
+    // Observers are not owned; remove one before destroying it
+    void addObserver(BackendObserver* observer);
+    void removeObserver(BackendObserver* observer);
+
+    // ========== Durability ==========
+    // Replay the write-ahead log at `path` into this backend, then log every
+    // addPatient/addSession to it. Recent visits are not logged.
+    bool openJournal(const std::string& path, const JournalOptions& options = JournalOptions());
+    void closeJournal();
+
+    // Versioned binary snapshot of everything, indexes included (snapshot.cpp).
+    // loadSnapshot() memory-maps the file and only works on an empty backend;
+    // call it before openJournal() so the log only replays newer records.
+    bool saveSnapshot(const std::string& path) const;
+    bool loadSnapshot(const std::string& path);
+    bool checkpoint(const std::string& snapshotPath);   // snapshot, then empty the journal
+
+private:
+    Patient& insertPatient(Patient p);
+    const Session& insertSession(Session s);
+    void restorePatient(const Patient& p);
+    void restoreSession(const Session& s);
+
+    std::string currentDate() const;
+    mutable long long cachedDateTime = -1;   // time() the cached date was computed for
+    mutable std::string cachedDate;
+
+    int globalPatientID = 1;
+    int globalSessionID = 1;
+    uint64_t revisionCount = 0;
+
+    // Patients live in a deque so Patient* handed out by getPatientByID()
+    // stays valid when more patients are added.
+    std::deque<Patient> allPatients;
+
+    // Dense ID -> slot table into allPatients (-1 = no such patient).
+    // IDs are handed out sequentially, so this stays compact.
+    std::vector<int> patientSlots;
+
+    // Trigram index over case-folded names, keyed by slot
+    NameIndex nameIndex;
+
+    // Slots in A-Z order, over nameIndex's folded names
+    NameOrder nameOrder;
+
+    // Guards allPatients' layout, patientSlots, nameIndex and nameOrder against
+    // background searches. Patient names never change once added.
+    mutable std::shared_mutex patientMutex;
+
+    // Slots ordered by visit count, updated by addSession()
+    VisitRanking visitRanking;
+
+    // Every session is stored once, as a node in this arena; the clinic-wide
+    // linked list and the per-patient chains thread through the same nodes
+    ChunkedArena<SessionNode> sessionArena;
+    SessionNode* sessionHead;
+    SessionNode* sessionTail;
+
+    // Per-patient session index, by patient slot
+    std::vector<SessionChain> sessionChains;
+
+    // Full-text index over session notes, keyed by arena position
+    NotesIndex notesIndex;
+
+    // Slots by latest session; session numbers are arena positions
+    RecencyOrder recencyOrder;
+
+    const SessionChain* chainFor(int patientID) const;
+
+    static const size_t RECENT_VISIT_MAX = 5;   // default capacity
+    RecentVisits recentVisits;
+
+    std::unique_ptr<Journal> journal;   // null = in-memory only
+
+    std::vector<BackendObserver*> observers;
+};
+
+#endif // BACKEND_H
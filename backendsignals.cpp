@@ -0,0 +1,29 @@
+#include "backendsignals.h"
+#include <climits>
+#include <algorithm>
+
+BackendSignals::BackendSignals(Backend* backendPtr, QObject* parent)
+    : QObject(parent), backend(backendPtr)
+{
+    backend->addObserver(this);
+}
+
+BackendSignals::~BackendSignals()
+{
+    backend->removeObserver(this);
+}
+
+void BackendSignals::onPatientsAdded(int firstID, size_t count)
+{
+    emit patientsAdded(firstID, static_cast<int>(std::min<size_t>(count, INT_MAX)));
+}
+
+void BackendSignals::onSessionAdded(const Session& session)
+{
+    emit sessionAdded(session.session_id, session.patientID);
+}
+
+void BackendSignals::onRecentVisitsChanged(int patientID)
+{
+    emit recentVisitsChanged(patientID);
+}
@@ -0,0 +1,30 @@
+#pragma once
+#include <QObject>
+#include "backend.h"
+
+// ================= BACKEND SIGNALS =================
+// Qt face of BackendObserver: re-emits every backend change as a signal,
+// so any number of open screens can patch just the rows that changed
+// instead of reloading. The Backend itself stays free of Qt.
+//
+// Signals are emitted synchronously from the mutating call, i.e. on the
+// GUI thread, after the change is visible through the Backend.
+class BackendSignals : public QObject, public BackendObserver
+{
+    Q_OBJECT
+public:
+    explicit BackendSignals(Backend* backend, QObject* parent = nullptr);
+    ~BackendSignals() override;
+
+signals:
+    void patientsAdded(int firstID, int count);   // one signal per addPatient() or bulk import
+    void sessionAdded(int sessionID, int patientID);
+    void recentVisitsChanged(int patientID);      // -1: reload the whole list
+
+private:
+    void onPatientsAdded(int firstID, size_t count) override;
+    void onSessionAdded(const Session& session) override;
+    void onRecentVisitsChanged(int patientID) override;
+
+    Backend* backend;
+};
@@ -0,0 +1,452 @@
+// Backend benchmarks.
+//
+// Build the `backend_bench` target and run it from a terminal. The core
+// cases (one per Backend operation the UI relies on) run at every dataset
+// size and report ops/s, p50/p99 latency and peak RSS; --json FILE also
+// writes them for comparing runs. See benchharness.h for the options.
+//
+//   backend_bench --sizes 1k,10k,100k,1M,10M --json backend.json
+//
+// --extended adds the older targeted benches (views, snapshot, import,
+// export, notes search, sort orders), which print their own lines.
+
+#include "backend.h"
+#include "bulkimport.h"
+#include "exporter.h"
+#include "trace.h"
+#include "benchharness.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double nsPerOp(Clock::time_point start, Clock::time_point end, size_t ops)
+{
+    return std::chrono::duration<double, std::nano>(end - start).count() / ops;
+}
+
+// Heap bytes in use, in MiB (glibc only; 0 elsewhere)
+double heapInUseMiB()
+{
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || __GLIBC_MINOR__ >= 33)
+    struct mallinfo2 info = mallinfo2();
+    return (info.uordblks + info.hblkhd) / (1024.0 * 1024.0);
+#else
+    return 0.0;
+#endif
+}
+
+void fillPatients(Backend& backend, size_t count)
+{
+    for (size_t i = 0; i < count; ++i) {
+        backend.addPatient("Patient " + std::to_string(i), i % 2 ? "Female" : "Male", "1990-01-01");
+    }
+}
+
+// ================= Core operations =================
+// One dataset per size, built by the cases themselves: addPatient fills
+// the registry with n patients, addSession records n visits, and the
+// read cases run against the result.
+const char* const firstNames[] = {"Ayesha", "Omar", "Fatima", "Bilal", "Sara", "Hamza", "Zainab",
+                                  "Ali", "Maryam", "Usman", "Hina", "Imran", "Noor", "Saad"};
+const char* const lastNames[] = {"Khan", "Ahmed", "Malik", "Hussain", "Sheikh", "Qureshi",
+                                 "Siddiqui", "Chaudhry", "Raza", "Butt", "Iqbal", "Mirza"};
+
+volatile long long sink;   // keeps the timed reads from being optimized away
+
+// Spreads i over 1..n without a table of random IDs (which would show up
+// in the peak RSS at 10M)
+int scatter(uint64_t i, size_t n)
+{
+    return 1 + static_cast<int>((i * 0x9E3779B97F4A7C15ull >> 17) % n);
+}
+
+void benchCore(bench::Suite& suite, size_t n)
+{
+    // A pool of realistic names, reused round-robin
+    std::mt19937 rng(7);
+    std::vector<std::string> names(65536);
+    for (std::string& name : names) {
+        name = std::string(firstNames[rng() % 14]) + " " + lastNames[rng() % 12] + " " +
+               std::to_string(rng() % 100000);
+    }
+
+    Backend backend;
+    suite.build("addPatient", n, n, 1, [&](uint64_t i) {
+        backend.addPatient(names[i % names.size()], i % 2 ? "Female" : "Male", "1990-01-01");
+    });
+
+    long long checksum = 0;
+    suite.run("getPatientByID", n, 1000000, 1, [&](uint64_t i) {
+        Patient* p = backend.getPatientByID(scatter(i, n));
+        if (p) checksum += p->id;
+    });
+
+    const char* const queries[] = {"fatima raza 4242", "qureshi 9", "hamza", "zz-no-match"};
+    suite.run("searchPatient", n, std::max<uint64_t>(20, 200000000 / n), 1, [&](uint64_t i) {
+        Patient* p = backend.searchPatient(queries[i % 4]);
+        if (p) checksum += p->id;
+    });
+
+    const std::string notes = "Follow-up visit, patient reports better sleep.";
+    suite.build("addSession", n, n, 1, [&](uint64_t i) {
+        backend.addSession(scatter(i, n), notes);
+    });
+
+    // Copies every patient, so fewer calls at larger sizes
+    suite.run("getFrequentlyVisited", n, std::max<uint64_t>(3, 10000000 / n), 1, [&](uint64_t) {
+        checksum += static_cast<long long>(backend.getFrequentlyVisited().size());
+    });
+
+    // What the dashboard asks for on every open: the top 10 by visit count
+    suite.run("getTopVisited", n, 1000000, 1, [&](uint64_t) {
+        checksum += static_cast<long long>(backend.getTopVisited(10).size());
+    });
+
+    suite.run("addRecentVisit", n, 1000000, 1, [&](uint64_t i) {
+        backend.addRecentVisit(scatter(i, n));
+    });
+
+    sink = checksum;
+}
+
+// ================= Tracing =================
+// Cost of one empty TRACE_SPAN, recording off and on (trace.h), and on
+// with open-span tracking as on the GUI thread under StallWatchdog. The
+// core cases above run with recording off.
+void benchTracing(bench::Suite& suite)
+{
+    suite.run("trace.spanOff", 0, 10000000, 1000, [](uint64_t) { TRACE_SPAN("bench", "span"); });
+
+    tracing::setEnabled(true);
+    suite.run("trace.spanOn", 0, 10000000, 1000, [](uint64_t) { TRACE_SPAN("bench", "span"); });
+    tracing::trackOpenSpans(true);
+    suite.run("trace.spanTracked", 0, 10000000, 1000, [](uint64_t) { TRACE_SPAN("bench", "span"); });
+    tracing::trackOpenSpans(false);
+    tracing::setEnabled(false);
+}
+
+// ================= Accessors =================
+// Old by-value accessors against the zero-copy views, walking every record.
+template <typename Fn>
+void timeWalk(const char* label, size_t records, Fn walk)
+{
+    const double heapBefore = heapInUseMiB();
+    double heapPeak = heapBefore;
+    auto start = Clock::now();
+    size_t checksum = walk(heapPeak);
+    auto end = Clock::now();
+
+    std::printf("%-28s records=%-9zu %8.1f ms  %8.1f MiB extra heap  (checksum %zu)\n",
+                label, records, std::chrono::duration<double, std::milli>(end - start).count(),
+                heapPeak - heapBefore, checksum);
+}
+
+void benchAccessors(size_t recordCount)
+{
+    Backend backend;
+    fillPatients(backend, recordCount);
+    const std::string notes = "Follow-up visit, patient reports better sleep.";
+    for (size_t i = 0; i < recordCount; ++i) {
+        backend.addSession(1 + static_cast<int>(i % recordCount), notes);
+    }
+
+    timeWalk("getAllPatients()", recordCount, [&](double& peak) {
+        std::vector<Patient> all = backend.getAllPatients();
+        peak = heapInUseMiB();
+        size_t sum = 0;
+        for (const Patient& p : all) sum += p.name.size();
+        return sum;
+    });
+    timeWalk("patients()", recordCount, [&](double& peak) {
+        size_t sum = 0;
+        for (const Patient& p : backend.patients()) sum += p.name.size();
+        peak = heapInUseMiB();
+        return sum;
+    });
+    timeWalk("patientsPage() x 100", recordCount, [&](double& peak) {
+        size_t sum = 0;
+        for (size_t offset = 0; offset < backend.patientCount(); offset += 100) {
+            for (const Patient& p : backend.patientsPage(offset, 100)) sum += p.name.size();
+        }
+        peak = heapInUseMiB();
+        return sum;
+    });
+    timeWalk("getAllSessionsLinkedList()", recordCount, [&](double& peak) {
+        std::vector<Session> all = backend.getAllSessionsLinkedList();
+        peak = heapInUseMiB();
+        size_t sum = 0;
+        for (const Session& s : all) sum += s.notes.size();
+        return sum;
+    });
+    timeWalk("sessions()", recordCount, [&](double& peak) {
+        size_t sum = 0;
+        for (const Session& s : backend.sessions()) sum += s.notes.size();
+        peak = heapInUseMiB();
+        return sum;
+    });
+    timeWalk("sessionsPage() x 100", recordCount, [&](double& peak) {
+        size_t sum = 0;
+        for (size_t offset = 0; offset < backend.sessionCount(); offset += 100) {
+            for (const Session& s : backend.sessionsPage(offset, 100)) sum += s.notes.size();
+        }
+        peak = heapInUseMiB();
+        return sum;
+    });
+}
+
+// ================= Snapshot =================
+// Startup cost: opening a snapshot versus replaying the same data from the log.
+void benchSnapshot(size_t sessionCount)
+{
+    const std::string snapshotPath = "backend_bench.snap";
+    const std::string journalPath = "backend_bench.wal";
+    std::remove(snapshotPath.c_str());
+    std::remove(journalPath.c_str());
+
+    {
+        Backend backend;
+        backend.openJournal(journalPath);
+        fillPatients(backend, 100000);
+        const std::string notes = "Follow-up visit, patient reports better sleep.";
+        for (size_t i = 0; i < sessionCount; ++i) {
+            backend.addSession(1 + static_cast<int>(i % 100000), notes);
+        }
+        backend.saveSnapshot(snapshotPath);
+    }
+
+    auto start = Clock::now();
+    {
+        Backend backend;
+        backend.loadSnapshot(snapshotPath);
+        auto end = Clock::now();
+        std::printf("loadSnapshot    sessions=%-9zu %8.1f ms  (%zu patients, %zu sessions)\n", sessionCount,
+                    std::chrono::duration<double, std::milli>(end - start).count(),
+                    backend.patientCount(), backend.sessionCount());
+    }
+
+    start = Clock::now();
+    {
+        Backend backend;
+        backend.openJournal(journalPath);
+        auto end = Clock::now();
+        std::printf("journal replay  sessions=%-9zu %8.1f ms  (%zu patients, %zu sessions)\n", sessionCount,
+                    std::chrono::duration<double, std::milli>(end - start).count(),
+                    backend.patientCount(), backend.sessionCount());
+    }
+
+    std::remove(snapshotPath.c_str());
+    std::remove(journalPath.c_str());
+}
+
+// ================= Bulk import =================
+// Rows per second through importPatients(), one addPatient() call per row
+// for comparison.
+void benchImport(size_t rowCount)
+{
+    const std::string csvPath = "backend_bench_import.csv";
+    {
+        std::FILE* csv = std::fopen(csvPath.c_str(), "wb");
+        std::fputs("name,gender,birth_date\n", csv);
+        std::mt19937 rng(3);
+        for (size_t i = 0; i < rowCount; ++i) {
+            std::fprintf(csv, "%s %s,%s,19%02u-%02u-%02u\n", firstNames[rng() % 14], lastNames[rng() % 12],
+                         i % 2 ? "Female" : "Male", static_cast<unsigned>(40 + rng() % 60),
+                         static_cast<unsigned>(1 + rng() % 12), static_cast<unsigned>(1 + rng() % 28));
+        }
+        std::fclose(csv);
+    }
+
+    {
+        Backend backend;
+        auto start = Clock::now();
+        ImportResult result = importPatients(backend, csvPath);
+        auto end = Clock::now();
+        double seconds = std::chrono::duration<double>(end - start).count();
+        std::printf("importPatients  rows=%-9zu %8.1f ms  %10.0f rows/s  (%zu imported, %zu rejected)\n",
+                    rowCount, seconds * 1000.0, result.imported / seconds, result.imported, result.rejected);
+    }
+
+    {
+        Backend backend;
+        auto start = Clock::now();
+        fillPatients(backend, rowCount);
+        auto end = Clock::now();
+        double seconds = std::chrono::duration<double>(end - start).count();
+        std::printf("addPatient loop rows=%-9zu %8.1f ms  %10.0f rows/s\n",
+                    rowCount, seconds * 1000.0, rowCount / seconds);
+    }
+
+    std::remove(csvPath.c_str());
+}
+
+// ================= Streaming export =================
+// Heap growth during an export should stay flat at any dataset size.
+void benchExport(size_t sessionCount, bool compress)
+{
+    if (compress && !exportCompressionAvailable()) return;
+
+    Backend backend;
+    fillPatients(backend, 100000);
+    const std::string notes = "Follow-up visit, patient reports better sleep.";
+    for (size_t i = 0; i < sessionCount; ++i) {
+        backend.addSession(1 + static_cast<int>(i % 100000), notes);
+    }
+
+    const std::string path = compress ? "backend_bench_export.csv.gz" : "backend_bench_export.csv";
+    const double before = heapInUseMiB();
+    double peak = before;
+    ExportOptions options;
+    options.compress = compress;
+    options.progress = [&](size_t, size_t) {
+        peak = std::max(peak, heapInUseMiB());
+        return true;
+    };
+
+    auto start = Clock::now();
+    ExportResult result = exportPatients(backend, path, options);
+    auto end = Clock::now();
+    std::printf("exportPatients  sessions=%-9zu %8.1f ms  %s %6.1f MiB out, heap +%.1f MiB\n", sessionCount,
+                std::chrono::duration<double, std::milli>(end - start).count(), compress ? "gzip" : "csv ",
+                result.bytesWritten / (1024.0 * 1024.0), peak - before);
+
+    std::remove(path.c_str());
+}
+
+// ================= Notes full-text search =================
+// Index build cost per note, index size, and query latency by query shape.
+void benchNotesSearch(size_t sessionCount)
+{
+    static const char* const words[] = {
+        "patient", "reports", "denies", "fever", "cough", "chest", "pain", "headache", "nausea",
+        "dizziness", "sleep", "better", "worse", "anxiety", "mood", "appetite", "follow", "up",
+        "prescribed", "amoxicillin", "amoxil", "ibuprofen", "paracetamol", "metformin", "dose",
+        "mg", "500", "250", "twice", "daily", "history", "of", "the", "and", "with", "no",
+        "blood", "pressure", "normal", "elevated", "weeks", "since", "last", "visit", "review"};
+    const size_t wordCount = sizeof(words) / sizeof(words[0]);
+
+    Backend backend;
+    fillPatients(backend, 100000);
+
+    // Skewed word choice, so common words are far more common than rare ones
+    std::mt19937 rng(11);
+    std::string notes;
+    auto start = Clock::now();
+    for (size_t i = 0; i < sessionCount; ++i) {
+        notes.clear();
+        size_t length = 8 + rng() % 24;
+        for (size_t w = 0; w < length; ++w) {
+            notes += words[std::min(rng() % wordCount, rng() % wordCount)];
+            notes += ' ';
+        }
+        backend.addSession(1 + static_cast<int>(i % 100000), notes);
+    }
+    auto end = Clock::now();
+    std::printf("addSession+notes sessions=%-8zu %8.1f ns/op\n", sessionCount, nsPerOp(start, end, sessionCount));
+
+    const char* const queries[] = {"metformin", "fever cough", "\"chest pain\"", "amox*",
+                                   "\"blood pressure\" elevated", "review weeks since"};
+    for (const char* query : queries) {
+        const int repeats = 20;
+        size_t found = 0;
+        start = Clock::now();
+        for (int r = 0; r < repeats; ++r) found += backend.searchNotes(query, 20).size();
+        end = Clock::now();
+        std::printf("searchNotes     sessions=%-9zu %8.2f ms  %-28s (%zu hits shown)\n", sessionCount,
+                    std::chrono::duration<double, std::milli>(end - start).count() / repeats, query,
+                    found / repeats);
+    }
+}
+
+// ================= Sort orders =================
+// Name and last-visit orders are maintained on insert; compare reading
+// rows in order against sorting the whole registry on demand.
+void benchSortOrders(size_t patientCount)
+{
+    std::mt19937 rng(3);
+    std::vector<std::string> names(patientCount);
+    for (std::string& name : names) {
+        name.clear();
+        for (int c = 0; c < 10; ++c) name += static_cast<char>((c == 0 ? 'A' : 'a') + rng() % 26);
+    }
+
+    Backend backend;
+    auto start = Clock::now();
+    for (const std::string& name : names) backend.addPatient(name, "Female", "1990-01-01");
+    auto end = Clock::now();
+    std::printf("addPatient(+orders) patients=%-8zu %8.1f ns/op\n", patientCount,
+                nsPerOp(start, end, patientCount));
+
+    start = Clock::now();
+    for (size_t i = 0; i < patientCount; ++i) {
+        backend.addSession(1 + static_cast<int>(rng() % patientCount), "");
+    }
+    end = Clock::now();
+    std::printf("addSession(+orders) patients=%-8zu %8.1f ns/op\n", patientCount,
+                nsPerOp(start, end, patientCount));
+
+    // What a re-sort per order switch costs
+    start = Clock::now();
+    std::vector<const Patient*> sorted;
+    sorted.reserve(patientCount);
+    for (const Patient& p : backend.patients()) sorted.push_back(&p);
+    std::sort(sorted.begin(), sorted.end(), [](const Patient* a, const Patient* b) {
+        return NameIndex::fold(a->name) < NameIndex::fold(b->name);
+    });
+    end = Clock::now();
+    std::printf("full re-sort        patients=%-8zu %8.2f ms\n", patientCount,
+                std::chrono::duration<double, std::milli>(end - start).count());
+
+    const size_t lookups = 1000000;
+    std::vector<size_t> rows(lookups);
+    for (size_t& row : rows) row = rng() % patientCount;
+
+    const PatientOrder orders[] = {PatientOrder::Name, PatientOrder::RecentVisit};
+    const char* const labels[] = {"name", "recent"};
+    for (int o = 0; o < 2; ++o) {
+        long long sum = 0;
+        start = Clock::now();
+        for (size_t row : rows) sum += backend.patientAt(row, orders[o]).id;
+        end = Clock::now();
+        std::printf("patientAt(%-6s)   patients=%-8zu %8.1f ns/op\n", labels[o], patientCount,
+                    nsPerOp(start, end, lookups));
+
+        start = Clock::now();
+        for (size_t row : rows) sum += static_cast<long long>(backend.rowOf(static_cast<int>(row) + 1, orders[o]));
+        end = Clock::now();
+        std::printf("rowOf(%-6s)       patients=%-8zu %8.1f ns/op  (%lld)\n", labels[o], patientCount,
+                    nsPerOp(start, end, lookups), sum % 10);
+    }
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    bench::Suite suite("backend_bench", {1000, 10000, 100000, 1000000}, argc, argv);
+    if (!suite.ok()) return suite.finish();
+
+    for (size_t n : suite.sizes()) benchCore(suite, n);
+    benchTracing(suite);
+
+    if (suite.hasFlag("--extended")) {
+        benchAccessors(1000000);
+        for (size_t n : {size_t(1000000), size_t(5000000)}) benchSnapshot(n);
+        for (size_t n : {size_t(100000), size_t(1000000)}) benchImport(n);
+        for (size_t n : {size_t(1000000), size_t(10000000)}) benchExport(n, false);
+        benchExport(10000000, true);
+        for (size_t n : {size_t(1000000), size_t(5000000)}) benchNotesSearch(n);
+        for (size_t n : {size_t(1000), size_t(10000), size_t(100000), size_t(1000000)}) benchSortOrders(n);
+    }
+
+    return suite.finish();
+}
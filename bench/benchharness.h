@@ -0,0 +1,419 @@
+// Shared by the bench targets: per-operation latency, throughput and peak
+// memory for each case, printed as a table and optionally written as JSON
+// (--json FILE) so runs can be compared release to release.
+//
+//   backend_bench --sizes 1k,100k,10M --json backend.json
+//
+// Plain C++, header only, so the Qt and non-Qt benches can share it.
+
+#ifndef BENCHHARNESS_H
+#define BENCHHARNESS_H
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <string>
+#include <utility>
+#include <vector>
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+namespace bench {
+
+using Clock = std::chrono::steady_clock;
+
+// ================= LATENCY HISTOGRAM =================
+// Log-linear buckets over nanoseconds: exact below 64 ns, then 32 buckets
+// per power of two (about 3% wide). Fixed size, so recording millions of
+// samples neither allocates nor shows up in the peak RSS being measured.
+class LatencyHistogram
+{
+public:
+    static const int BUCKETS = 64 + 58 * 32;
+
+    LatencyHistogram() : counts(BUCKETS, 0) {}
+
+    void record(uint64_t ns, uint64_t times = 1)
+    {
+        counts[bucketOf(ns)] += times;
+        total += times;
+        sum += static_cast<double>(ns) * times;
+        maxSeen = std::max(maxSeen, ns);
+    }
+
+    void merge(const LatencyHistogram& other)
+    {
+        for (int b = 0; b < BUCKETS; ++b) counts[b] += other.counts[b];
+        total += other.total;
+        sum += other.sum;
+        maxSeen = std::max(maxSeen, other.maxSeen);
+    }
+
+    void clear()
+    {
+        std::fill(counts.begin(), counts.end(), 0);
+        total = 0;
+        sum = 0;
+        maxSeen = 0;
+    }
+
+    uint64_t count() const { return total; }
+    double mean() const { return total ? sum / total : 0.0; }
+    uint64_t max() const { return maxSeen; }
+
+    // Smallest recorded value v such that a fraction q of samples are <= v,
+    // to bucket precision (bucket midpoint)
+    double percentile(double q) const
+    {
+        if (total == 0) return 0.0;
+        const uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(q * total)));
+        uint64_t seen = 0;
+        for (int b = 0; b < BUCKETS; ++b) {
+            seen += counts[b];
+            if (seen >= rank) return std::min(midpoint(b), static_cast<double>(maxSeen));
+        }
+        return static_cast<double>(maxSeen);
+    }
+
+    // Non-empty buckets as (lower bound ns, count), for plotting
+    std::vector<std::pair<uint64_t, uint64_t>> buckets() const
+    {
+        std::vector<std::pair<uint64_t, uint64_t>> out;
+        for (int b = 0; b < BUCKETS; ++b) {
+            if (counts[b]) out.emplace_back(lowerBound(b), counts[b]);
+        }
+        return out;
+    }
+
+private:
+    static int bucketOf(uint64_t ns)
+    {
+        if (ns < 64) return static_cast<int>(ns);
+        int msb = 63;
+        while (!(ns >> msb)) --msb;
+        const int shift = msb - 5;   // ns >> shift is in [32, 64)
+        return 64 + (shift - 1) * 32 + static_cast<int>((ns >> shift) - 32);
+    }
+    static uint64_t lowerBound(int b)
+    {
+        if (b < 64) return static_cast<uint64_t>(b);
+        const int shift = (b - 64) / 32 + 1;
+        return static_cast<uint64_t>((b - 64) % 32 + 32) << shift;
+    }
+    static double midpoint(int b)
+    {
+        if (b < 64) return b;
+        const int shift = (b - 64) / 32 + 1;
+        return lowerBound(b) + (uint64_t(1) << shift) / 2.0;
+    }
+
+    std::vector<uint64_t> counts;
+    uint64_t total = 0;
+    double sum = 0;
+    uint64_t maxSeen = 0;
+};
+
+// ================= PEAK RSS =================
+// On Linux the high-water mark is reset before each case, so the figure is
+// that case's peak (dataset included). Elsewhere it is the peak so far.
+inline void resetPeakRss()
+{
+#if defined(__linux__)
+    if (std::FILE* f = std::fopen("/proc/self/clear_refs", "w")) {
+        std::fputs("5", f);
+        std::fclose(f);
+    }
+#endif
+}
+
+inline double peakRssMiB()
+{
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return counters.PeakWorkingSetSize / (1024.0 * 1024.0);
+    }
+    return 0.0;
+#else
+#if defined(__linux__)
+    if (std::FILE* f = std::fopen("/proc/self/status", "r")) {
+        char line[256];
+        long kib = -1;
+        while (std::fgets(line, sizeof(line), f)) {
+            if (std::sscanf(line, "VmHWM: %ld kB", &kib) == 1) break;
+        }
+        std::fclose(f);
+        if (kib >= 0) return kib / 1024.0;
+    }
+#endif
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+#if defined(__APPLE__)
+    return usage.ru_maxrss / (1024.0 * 1024.0);   // bytes
+#else
+    return usage.ru_maxrss / 1024.0;              // KiB
+#endif
+#endif
+}
+
+// ================= SIZES =================
+// "1000,10k,2.5M,10M" -> {1000, 10000, 2500000, 10000000}; empty on error
+inline std::vector<size_t> parseSizes(const char* list)
+{
+    std::vector<size_t> sizes;
+    const char* p = list;
+    while (*p) {
+        char* end = nullptr;
+        double value = std::strtod(p, &end);
+        if (end == p || value <= 0) return {};
+        if (*end == 'k' || *end == 'K') { value *= 1e3; ++end; }
+        else if (*end == 'm' || *end == 'M') { value *= 1e6; ++end; }
+        sizes.push_back(static_cast<size_t>(value + 0.5));
+        if (*end == ',') ++end;
+        else if (*end) return {};
+        p = end;
+    }
+    return sizes;
+}
+
+// ================= RESULTS =================
+struct Result {
+    std::string name;
+    size_t size = 0;          // dataset size the case ran against
+    uint64_t ops = 0;
+    size_t batch = 1;         // operations per timed sample
+    double seconds = 0;
+    double p50 = 0, p99 = 0, mean = 0, max = 0;   // ns per operation; NaN if not measured
+    double peakRssMiB = 0;
+    std::vector<std::pair<uint64_t, uint64_t>> histogram;   // optional, see LatencyHistogram::buckets()
+};
+
+// Result for samples recorded elsewhere (e.g. a replayed trace), one
+// operation per sample
+inline Result summarize(const std::string& name, size_t size, const LatencyHistogram& histogram,
+                        bool withBuckets = false)
+{
+    Result r;
+    r.name = name;
+    r.size = size;
+    r.ops = histogram.count();
+    r.seconds = histogram.mean() * histogram.count() / 1e9;
+    r.p50 = histogram.percentile(0.50);
+    r.p99 = histogram.percentile(0.99);
+    r.mean = histogram.mean();
+    r.max = static_cast<double>(histogram.max());
+    r.peakRssMiB = peakRssMiB();
+    if (withBuckets) r.histogram = histogram.buckets();
+    return r;
+}
+
+// Times `ops` calls of fn(i), i = 0 .. ops-1, `batch` calls per clock
+// read. With batch 1 every call is a sample and p50/p99/max are real
+// per-call latencies, clock overhead included (20-35 ns). A larger batch
+// keeps that overhead out of operations that take a few nanoseconds, but
+// then only throughput and the mean are known: p50/p99/max of batch means
+// would hide the slow calls, so they are left as NaN.
+template <typename Fn>
+Result measure(const std::string& name, size_t size, uint64_t ops, size_t batch, Fn&& fn)
+{
+    LatencyHistogram histogram;
+    batch = std::max<size_t>(1, batch);
+    resetPeakRss();
+
+    double seconds = 0;
+    for (uint64_t i = 0; i < ops;) {
+        const uint64_t end = std::min<uint64_t>(ops, i + batch);
+        const uint64_t count = end - i;
+        const auto start = Clock::now();
+        for (; i < end; ++i) fn(i);
+        const double ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+        histogram.record(static_cast<uint64_t>(ns / count), count);
+        seconds += ns / 1e9;
+    }
+
+    Result r;
+    r.name = name;
+    r.size = size;
+    r.ops = ops;
+    r.batch = batch;
+    r.seconds = seconds;
+    r.mean = histogram.mean();
+    if (batch == 1) {
+        r.p50 = histogram.percentile(0.50);
+        r.p99 = histogram.percentile(0.99);
+        r.max = static_cast<double>(histogram.max());
+    } else {
+        r.p50 = r.p99 = r.max = std::nan("");
+    }
+    r.peakRssMiB = peakRssMiB();
+    return r;
+}
+
+// "%10.0f", or "-" for a value that was not measured
+inline std::string column(double value)
+{
+    char text[32];
+    if (std::isnan(value)) std::snprintf(text, sizeof(text), "%10s", "-");
+    else std::snprintf(text, sizeof(text), "%10.0f", value);
+    return text;
+}
+
+// JSON number, or null for a value that was not measured
+inline std::string jsonNumber(double value)
+{
+    char text[32];
+    if (std::isnan(value)) std::snprintf(text, sizeof(text), "null");
+    else std::snprintf(text, sizeof(text), "%.1f", value);
+    return text;
+}
+
+// ================= SUITE =================
+// Command line, the running table and the JSON file for one bench target.
+//   --sizes LIST   dataset sizes (see parseSizes)
+//   --json FILE    also write every result to FILE
+//   --filter TEXT  only cases whose name contains TEXT
+class Suite
+{
+public:
+    Suite(const char* suiteName, std::vector<size_t> defaultSizes, int argc, char* argv[])
+        : suite(suiteName), sizeList(std::move(defaultSizes))
+    {
+        for (int i = 1; i < argc; ++i) {
+            const bool hasValue = i + 1 < argc;
+            if (std::strcmp(argv[i], "--sizes") == 0 && hasValue) {
+                sizeList = parseSizes(argv[++i]);
+                if (sizeList.empty()) usageError = true;
+            } else if (std::strcmp(argv[i], "--json") == 0 && hasValue) {
+                jsonPath = argv[++i];
+            } else if (std::strcmp(argv[i], "--filter") == 0 && hasValue) {
+                filterText = argv[++i];
+            } else {
+                extraArgs.push_back(argv[i]);
+            }
+        }
+        if (usageError) {
+            std::fprintf(stderr, "usage: %s [--sizes 1k,100k,1M,10M] [--json FILE] [--filter NAME]\n", suiteName);
+        }
+    }
+
+    bool ok() const { return !usageError; }
+    const std::vector<size_t>& sizes() const { return sizeList; }
+    bool hasFlag(const char* flag) const
+    {
+        return std::find(extraArgs.begin(), extraArgs.end(), std::string(flag)) != extraArgs.end();
+    }
+    // The argument after `flag`, for options the suite itself does not know
+    const char* option(const char* flag, const char* fallback = nullptr) const
+    {
+        for (size_t i = 0; i + 1 < extraArgs.size(); ++i) {
+            if (extraArgs[i] == flag) return extraArgs[i + 1].c_str();
+        }
+        return fallback;
+    }
+    bool wants(const std::string& name) const
+    {
+        return filterText.empty() || name.find(filterText) != std::string::npos;
+    }
+
+    // False if --filter skipped the case
+    template <typename Fn>
+    bool run(const std::string& name, size_t size, uint64_t ops, size_t batch, Fn&& fn)
+    {
+        if (!wants(name)) return false;
+        add(measure(name, size, ops, batch, std::forward<Fn>(fn)));
+        return true;
+    }
+
+    // For cases that build the dataset later cases read: a case skipped by
+    // --filter still runs, untimed
+    template <typename Fn>
+    void build(const std::string& name, size_t size, uint64_t ops, size_t batch, Fn&& fn)
+    {
+        if (run(name, size, ops, batch, fn)) return;
+        for (uint64_t i = 0; i < ops; ++i) fn(i);
+    }
+
+    void add(const Result& r)
+    {
+        if (results.empty()) {
+            std::printf("%-28s %10s %10s %14s %10s %10s %10s\n", "case", "size", "ops", "ops/s", "p50 ns",
+                        "p99 ns", "peak MiB");
+        }
+        std::printf("%-28s %10zu %10llu %14.0f %s %s %10.1f\n", r.name.c_str(), r.size,
+                    static_cast<unsigned long long>(r.ops), r.seconds > 0 ? r.ops / r.seconds : 0.0,
+                    column(r.p50).c_str(), column(r.p99).c_str(), r.peakRssMiB);
+        std::fflush(stdout);
+        results.push_back(r);
+    }
+
+    // Writes the JSON file if one was asked for; returns main()'s exit code
+    int finish() const
+    {
+        if (usageError) return 2;
+        if (jsonPath.empty()) return 0;
+
+        std::FILE* out = std::fopen(jsonPath.c_str(), "w");
+        if (!out) {
+            std::fprintf(stderr, "cannot write %s\n", jsonPath.c_str());
+            return 1;
+        }
+        char stamp[32];
+        std::time_t now = std::time(nullptr);
+        std::strftime(stamp, sizeof(stamp), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+
+        std::fprintf(out, "{\n  \"suite\": \"%s\",\n  \"timestamp\": \"%s\",\n", suite.c_str(), stamp);
+#if defined(NDEBUG)
+        std::fprintf(out, "  \"build\": \"release\",\n");
+#else
+        std::fprintf(out, "  \"build\": \"debug\",\n");
+#endif
+        std::fprintf(out, "  \"results\": [");
+        for (size_t i = 0; i < results.size(); ++i) {
+            const Result& r = results[i];
+            std::fprintf(out,
+                         "%s\n    {\"case\": \"%s\", \"size\": %zu, \"ops\": %llu, \"batch\": %zu, "
+                         "\"seconds\": %.6f, \"ops_per_sec\": %.1f, \"p50_ns\": %s, \"p99_ns\": %s, "
+                         "\"mean_ns\": %.1f, \"max_ns\": %s, \"peak_rss_mib\": %.1f",
+                         i ? "," : "", r.name.c_str(), r.size, static_cast<unsigned long long>(r.ops), r.batch,
+                         r.seconds, r.seconds > 0 ? r.ops / r.seconds : 0.0, jsonNumber(r.p50).c_str(),
+                         jsonNumber(r.p99).c_str(), r.mean, jsonNumber(r.max).c_str(), r.peakRssMiB);
+            if (!r.histogram.empty()) {
+                // [lower bound ns, count] per non-empty bucket
+                std::fprintf(out, ", \"histogram\": [");
+                for (size_t b = 0; b < r.histogram.size(); ++b) {
+                    std::fprintf(out, "%s[%llu, %llu]", b ? ", " : "",
+                                 static_cast<unsigned long long>(r.histogram[b].first),
+                                 static_cast<unsigned long long>(r.histogram[b].second));
+                }
+                std::fprintf(out, "]");
+            }
+            std::fprintf(out, "}");
+        }
+        std::fprintf(out, "\n  ]\n}\n");
+        return std::fclose(out) == 0 ? 0 : 1;
+    }
+
+private:
+    std::string suite;
+    std::vector<size_t> sizeList;
+    std::string jsonPath;
+    std::string filterText;
+    std::vector<std::string> extraArgs;
+    std::vector<Result> results;
+    bool usageError = false;
+};
+
+} // namespace bench
+
+#endif // BENCHHARNESS_H
@@ -0,0 +1,229 @@
+// Replays a workload_gen directory through the Backend API, headless, and
+// reports throughput and latency per operation type (see workload.h).
+//
+//   replay_bench --dir load-2M [--days 5] [--rate max|N] [--speed X]
+//                [--journal FILE] [--json FILE]
+//
+// Setup, untimed per call: registry.csv goes in through importPatients(),
+// then history.trace (if present) is replayed as fast as possible. Then
+// day.trace is replayed --days times:
+//   --rate max   back to back (default)
+//   --rate N     N events per second, ignoring the trace's clock
+//   --speed X    on the trace's clock, X times faster than real time
+// When paced, "replay.scheduleLag" is how late each event started; a
+// Backend call that overruns its slot delays the ones behind it, and the
+// lag shows it even though service times alone would not.
+//
+// Session dates come from Backend's clock, not the trace: the history
+// ages the indexes and ranking, not the dates shown.
+
+#include "backend.h"
+#include "bulkimport.h"
+#include "workload.h"
+#include "benchharness.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using workload::Event;
+using workload::Op;
+
+const int OPS = 128;   // LatencyHistogram per Op, indexed by its letter
+const size_t TYPE_AHEAD_LIMIT = 8;
+const size_t TOP_SHOWN = 10;
+const size_t PAGE_ROWS = 20;
+
+volatile long long sink = 0;
+
+// One event, as the screens would make the calls
+void apply(Backend& backend, const Event& e)
+{
+    switch (e.op) {
+    case Op::AddPatient:
+        sink += backend.addPatient(e.text, e.gender, e.birthDate).id;
+        break;
+    case Op::LookupPatient:
+        sink += backend.getPatientByID(e.id) != nullptr;
+        break;
+    case Op::TypeAhead:
+        sink += backend.searchPatients(e.text, TYPE_AHEAD_LIMIT).size();
+        break;
+    case Op::SearchPatient:
+        sink += backend.searchPatient(e.text) != nullptr;
+        break;
+    case Op::AddSession:
+        if (backend.getPatientByID(e.id)) sink += backend.addSession(e.id, e.text).session_id;
+        break;
+    case Op::AddRecentVisit:
+        backend.addRecentVisit(e.id);
+        break;
+    case Op::PatientHistory:
+        sink += backend.getSessionsForPatient(e.id).size();
+        break;
+    case Op::SearchNotes:
+        sink += backend.searchNotes(e.text).size();
+        break;
+    case Op::Dashboard:
+        for (int id : backend.getRecentVisits()) sink += backend.getPatientByID(id) != nullptr;
+        sink += backend.getTopVisited(TOP_SHOWN).size();
+        break;
+    case Op::ListPage: {
+        const size_t count = backend.patientCount();
+        if (count == 0) break;
+        const PatientOrder order = e.text == "recent" ? PatientOrder::RecentVisit : PatientOrder::Name;
+        const size_t first = static_cast<size_t>(e.id) % count;
+        for (size_t row = first; row < count && row < first + PAGE_ROWS; ++row) {
+            sink += backend.patientAt(row, order).id;
+        }
+        break;
+    }
+    }
+}
+
+double secondsSince(bench::Clock::time_point start)
+{
+    return std::chrono::duration<double>(bench::Clock::now() - start).count();
+}
+
+// Sleeps for most of the wait and spins the rest: sleep granularity is
+// coarser than the gaps between events at high rates
+void waitUntil(bench::Clock::time_point when)
+{
+    const auto spinFrom = when - std::chrono::microseconds(200);
+    if (bench::Clock::now() < spinFrom) std::this_thread::sleep_until(spinFrom);
+    while (bench::Clock::now() < when) {
+    }
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    bench::Suite suite("replay_bench", {}, argc, argv);
+    const char* dirArg = suite.option("--dir");
+    const char* rateArg = suite.option("--rate", "max");
+    const double speed = std::atof(suite.option("--speed", "0"));
+    const int days = std::atoi(suite.option("--days", "1"));
+    const double rate = std::strcmp(rateArg, "max") == 0 ? 0.0 : std::atof(rateArg);
+
+    if (!suite.ok() || !dirArg || days < 1 || speed < 0 || rate < 0 || (rate > 0 && speed > 0) ||
+        (std::strcmp(rateArg, "max") != 0 && rate <= 0)) {
+        std::fprintf(stderr,
+                     "usage: replay_bench --dir DIR [--days N] [--rate max|N | --speed X] [--journal FILE]"
+                     " [--json FILE] [--filter NAME]\n");
+        return 2;
+    }
+    const std::string dir = std::string(dirArg) + "/";
+
+    Backend backend;
+    if (const char* journalPath = suite.option("--journal")) {
+        std::remove(journalPath);
+        if (!backend.openJournal(journalPath)) {
+            std::fprintf(stderr, "cannot open journal %s\n", journalPath);
+            return 1;
+        }
+    }
+
+    // ---------- Setup ----------
+    auto start = bench::Clock::now();
+    ImportResult imported = importPatients(backend, dir + "registry.csv");
+    if (!imported.ok) {
+        std::fprintf(stderr, "%s\n", imported.error.c_str());
+        return 1;
+    }
+    std::printf("setup: %zu patients imported in %.2f s", imported.imported, secondsSince(start));
+    if (imported.rejected) std::printf(" (%zu rejected)", imported.rejected);
+    std::printf("\n");
+
+    workload::TraceReader reader;
+    Event e;
+    if (reader.open(dir + "history.trace")) {
+        start = bench::Clock::now();
+        size_t replayed = 0;
+        while (reader.next(e)) {
+            apply(backend, e);
+            ++replayed;
+        }
+        if (!reader.error().empty()) {
+            std::fprintf(stderr, "history.trace: %s\n", reader.error().c_str());
+            return 1;
+        }
+        const double seconds = secondsSince(start);
+        std::printf("setup: %zu history events in %.2f s (%.0f/s), %zu sessions\n", replayed, seconds,
+                    seconds > 0 ? replayed / seconds : 0.0, backend.sessionCount());
+    }
+
+    // The day is read up front so parsing stays out of the timings
+    std::vector<Event> day;
+    if (!reader.open(dir + "day.trace")) {
+        std::fprintf(stderr, "%s\n", reader.error().c_str());
+        return 1;
+    }
+    while (reader.next(e)) day.push_back(e);
+    if (!reader.error().empty()) {
+        std::fprintf(stderr, "day.trace: %s\n", reader.error().c_str());
+        return 1;
+    }
+    if (day.empty()) {
+        std::fprintf(stderr, "day.trace has no events\n");
+        return 1;
+    }
+
+    // ---------- Replay ----------
+    std::vector<bench::LatencyHistogram> perOp(OPS);
+    bench::LatencyHistogram all;
+    bench::LatencyHistogram lag;
+    const bool paced = rate > 0 || speed > 0;
+    const uint64_t dayUs = day.back().timeUs + 1;
+
+    bench::resetPeakRss();
+    const auto replayStart = bench::Clock::now();
+    uint64_t index = 0;
+    for (int d = 0; d < days; ++d) {
+        for (const Event& event : day) {
+            if (paced) {
+                const double offsetUs = rate > 0 ? index * 1e6 / rate : (d * dayUs + event.timeUs) / speed;
+                const auto due = replayStart + std::chrono::duration_cast<bench::Clock::duration>(
+                                                   std::chrono::duration<double, std::micro>(offsetUs));
+                waitUntil(due);
+                lag.record(static_cast<uint64_t>(
+                    std::chrono::duration<double, std::nano>(bench::Clock::now() - due).count()));
+            }
+            const auto callStart = bench::Clock::now();
+            apply(backend, event);
+            const uint64_t ns = static_cast<uint64_t>(
+                std::chrono::duration<double, std::nano>(bench::Clock::now() - callStart).count());
+            perOp[static_cast<unsigned char>(event.op)].record(ns);
+            all.record(ns);
+            ++index;
+        }
+    }
+    const double wall = secondsSince(replayStart);
+
+    // ops/s per operation is over its own busy time; replay.all is over
+    // the wall clock, pacing included
+    const size_t patients = backend.patientCount();
+    for (int op = 0; op < OPS; ++op) {
+        if (perOp[op].count() == 0) continue;
+        const std::string name = std::string("replay.") + workload::opName(static_cast<Op>(op));
+        if (suite.wants(name)) suite.add(bench::summarize(name, patients, perOp[op], true));
+    }
+    if (suite.wants("replay.all")) {
+        bench::Result total = bench::summarize("replay.all", patients, all, true);
+        total.seconds = wall;
+        suite.add(total);
+    }
+    if (paced && suite.wants("replay.scheduleLag")) {
+        suite.add(bench::summarize("replay.scheduleLag", patients, lag, true));
+    }
+
+    std::printf("replayed %llu events over %d day(s) in %.2f s; %zu patients, %zu sessions\n",
+                static_cast<unsigned long long>(index), days, wall, patients, backend.sessionCount());
+    return suite.finish();
+}
@@ -0,0 +1,168 @@
+// Screen-switch latency, before and after the Navigator, and the cost of
+// constructing each screen.
+//
+// "rebuild" is the old navigation: every click built a brand-new top-level
+// window (setupUi and all its widgets) and deleted the previous one.
+// "cached" flips pages in the Navigator's stack, resetting the form only.
+//
+// "dashboard" times one saved visit (addSession + addRecentVisit) with an
+// open dashboard: "full" rebuilds both lists the way every save used to,
+// "delta" lets BackendSignals patch the rows that changed. The delta also
+// runs during "full", so the gap between them is the rebuild.
+//
+// "construct" builds one screen, shows it until it is polished and
+// painted, and deletes it. That is the cost the app-wide stylesheet
+// (theme.cpp) cuts; compare against a build from before it.
+//
+// Run on a headless box with QT_QPA_PLATFORM=offscreen.
+
+#include "navigator.h"
+#include "mainwindow.h"
+#include "dashboardwindow.h"
+#include "addpatientwindow.h"
+#include "addsessionwindow.h"
+#include "viewpatientwindow.h"
+#include "theme.h"
+#include <QApplication>
+#include <QElapsedTimer>
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace {
+
+// The path a front-desk user clicks through most
+const Screen ROUTE[] = {Screen::Dashboard, Screen::AddSession, Screen::Dashboard,
+                        Screen::AddPatient, Screen::Dashboard, Screen::ViewPatients};
+
+QMainWindow* buildScreen(Screen screen, Backend* backend, Navigator* navigator)
+{
+    switch (screen) {
+    case Screen::Welcome:      return new MainWindow(backend, navigator);
+    case Screen::Dashboard:    return new DashboardWindow(backend, navigator);
+    case Screen::AddPatient:   return new AddPatientWindow(backend, navigator);
+    case Screen::AddSession:   return new AddSessionWindow(backend, navigator);
+    case Screen::ViewPatients: return new ViewPatientWindow(backend, navigator);
+    }
+    return nullptr;
+}
+
+const char* screenName(Screen screen)
+{
+    switch (screen) {
+    case Screen::Welcome:      return "welcome";
+    case Screen::Dashboard:    return "dashboard";
+    case Screen::AddPatient:   return "addpatient";
+    case Screen::AddSession:   return "addsession";
+    case Screen::ViewPatients: return "viewpatients";
+    }
+    return "?";
+}
+
+void report(const char* label, std::vector<double> ms)
+{
+    std::sort(ms.begin(), ms.end());
+    double total = 0;
+    for (double m : ms) total += m;
+    std::printf("%-12s runs=%-4zu mean %7.2f ms  p50 %7.2f ms  p99 %7.2f ms\n", label, ms.size(),
+                total / ms.size(), ms[ms.size() / 2], ms[std::min(ms.size() - 1, ms.size() * 99 / 100)]);
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    QApplication app(argc, argv);
+    Theme::apply(app);
+
+    Backend backend;
+    for (int i = 0; i < 1000; ++i) {
+        backend.addPatient("Patient " + std::to_string(i), i % 2 ? "Female" : "Male", "1990-01-01");
+    }
+    for (int i = 0; i < 5000; ++i) {
+        backend.addSession(1 + i % 1000, "Follow-up visit");
+        backend.addRecentVisit(1 + i % 1000);
+    }
+
+    const int rounds = 30;
+    Navigator navigator(&backend);
+    navigator.show();
+    app.processEvents();
+
+    // === Before: a new window per click ===
+    std::vector<double> rebuild;
+    QMainWindow* previous = nullptr;
+    for (int r = 0; r < rounds; ++r) {
+        for (Screen screen : ROUTE) {
+            QElapsedTimer clock;
+            clock.start();
+            QMainWindow* window = buildScreen(screen, &backend, &navigator);
+            window->show();
+            if (previous) previous->close();
+            app.processEvents();
+            rebuild.push_back(clock.nsecsElapsed() / 1e6);
+
+            delete previous;
+            previous = window;
+        }
+    }
+    delete previous;
+
+    // === After: pages built once, then flipped ===
+    std::vector<double> cached;
+    for (int r = 0; r < rounds; ++r) {
+        for (Screen screen : ROUTE) {
+            QElapsedTimer clock;
+            clock.start();
+            navigator.go(screen);
+            app.processEvents();
+            if (r > 0) cached.push_back(clock.nsecsElapsed() / 1e6);   // round 0 builds the pages
+        }
+    }
+
+    // === Window construction, per screen ===
+    std::printf("construct:\n");
+    for (Screen screen : {Screen::Welcome, Screen::Dashboard, Screen::AddPatient,
+                          Screen::AddSession, Screen::ViewPatients}) {
+        std::vector<double> built;
+        for (int r = 0; r < rounds; ++r) {
+            QElapsedTimer clock;
+            clock.start();
+            QMainWindow* window = buildScreen(screen, &backend, &navigator);
+            window->show();
+            app.processEvents();
+            built.push_back(clock.nsecsElapsed() / 1e6);
+            delete window;
+        }
+        report(screenName(screen), built);
+    }
+
+    // === Dashboard update per saved visit ===
+    DashboardWindow* dashboard = new DashboardWindow(&backend, &navigator);
+    std::vector<double> full, delta;
+    for (int r = 0; r < rounds * 10; ++r) {
+        const int patientID = 1 + (r * 37) % 1000;
+        QElapsedTimer clock;
+        clock.start();
+        backend.addSession(patientID, "Follow-up visit");   // the delta runs in here
+        backend.addRecentVisit(patientID);
+        delta.push_back(clock.nsecsElapsed() / 1e6);
+
+        clock.start();
+        backend.addSession(patientID, "Follow-up visit");
+        backend.addRecentVisit(patientID);
+        dashboard->refreshDashboard();
+        full.push_back(clock.nsecsElapsed() / 1e6);
+    }
+    delete dashboard;
+
+    std::printf("dashboard:\n");
+    report("full", full);
+    report("delta", delta);
+
+    std::printf("switch:\n");
+    report("rebuild", rebuild);
+    report("cached", cached);
+    return 0;
+}
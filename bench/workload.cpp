@@ -0,0 +1,343 @@
+#include "workload.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <numeric>
+
+namespace workload {
+
+// ================= ZIPF SAMPLER =================
+namespace {
+
+// log1p(x) / x and expm1(x) / x, accurate near 0
+double helper1(double x)
+{
+    if (std::fabs(x) > 1e-8) return std::log1p(x) / x;
+    return 1 - x * (0.5 - x * (1.0 / 3 - 0.25 * x));
+}
+
+double helper2(double x)
+{
+    if (std::fabs(x) > 1e-8) return std::expm1(x) / x;
+    return 1 + x * 0.5 * (1 + x / 3 * (1 + 0.25 * x));
+}
+
+} // namespace
+
+ZipfSampler::ZipfSampler(uint64_t n, double exponent)
+    : n(std::max<uint64_t>(1, n)), exponent(exponent)
+{
+    hIntegralX1 = hIntegral(1.5) - 1;
+    hIntegralN = hIntegral(this->n + 0.5);
+    s = 2 - hIntegralInverse(hIntegral(2.5) - h(2));
+}
+
+double ZipfSampler::h(double x) const
+{
+    return std::exp(-exponent * std::log(x));
+}
+
+double ZipfSampler::hIntegral(double x) const
+{
+    const double logX = std::log(x);
+    return helper2((1 - exponent) * logX) * logX;
+}
+
+double ZipfSampler::hIntegralInverse(double x) const
+{
+    double t = x * (1 - exponent);
+    if (t < -1) t = -1;   // rounding at the far end of the range
+    return std::exp(helper1(t) * x);
+}
+
+uint64_t ZipfSampler::operator()(std::mt19937_64& rng) const
+{
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    for (;;) {
+        const double u = hIntegralN + uniform(rng) * (hIntegralX1 - hIntegralN);
+        const double x = hIntegralInverse(u);
+        uint64_t k = static_cast<uint64_t>(x + 0.5);
+        k = std::min(std::max<uint64_t>(k, 1), n);
+        if (k - x <= s || u >= hIntegral(k + 0.5) - h(static_cast<double>(k))) return k;
+    }
+}
+
+// ================= TRACE EVENTS =================
+bool isKnownOp(char op)
+{
+    return std::string("PGTQSRHNDL").find(op) != std::string::npos;
+}
+
+const char* opName(Op op)
+{
+    switch (op) {
+    case Op::AddPatient:     return "addPatient";
+    case Op::LookupPatient:  return "getPatientByID";
+    case Op::TypeAhead:      return "searchPatients";
+    case Op::SearchPatient:  return "searchPatient";
+    case Op::AddSession:     return "addSession";
+    case Op::AddRecentVisit: return "addRecentVisit";
+    case Op::PatientHistory: return "getSessionsForPatient";
+    case Op::SearchNotes:    return "searchNotes";
+    case Op::Dashboard:      return "dashboard";
+    case Op::ListPage:       return "listPage";
+    }
+    return "?";
+}
+
+void writeEvent(std::FILE* out, const Event& e)
+{
+    std::fprintf(out, "%llu\t%c\t%d\t%s", static_cast<unsigned long long>(e.timeUs), static_cast<char>(e.op), e.id,
+                 e.text.c_str());
+    if (e.op == Op::AddPatient) std::fprintf(out, "\t%s\t%s", e.gender.c_str(), e.birthDate.c_str());
+    std::fputc('\n', out);
+}
+
+bool TraceReader::open(const std::string& path)
+{
+    in.close();
+    in.clear();
+    in.open(path);
+    lineNumber = 0;
+    message.clear();
+    if (!in) message = "cannot open " + path;
+    return static_cast<bool>(in);
+}
+
+bool TraceReader::next(Event& e)
+{
+    while (std::getline(in, line)) {
+        ++lineNumber;
+        if (line.empty() || line[0] == '#') continue;
+
+        std::vector<std::string> fields;
+        size_t start = 0;
+        for (;;) {
+            const size_t tab = line.find('\t', start);
+            fields.push_back(line.substr(start, tab == std::string::npos ? std::string::npos : tab - start));
+            if (tab == std::string::npos) break;
+            start = tab + 1;
+        }
+        if (fields.size() < 3 || fields[1].size() != 1 || !isKnownOp(fields[1][0])) {
+            message = "bad event on line " + std::to_string(lineNumber);
+            return false;
+        }
+        e.timeUs = std::strtoull(fields[0].c_str(), nullptr, 10);
+        e.op = static_cast<Op>(fields[1][0]);
+        e.id = std::atoi(fields[2].c_str());
+        e.text = fields.size() > 3 ? fields[3] : std::string();
+        e.gender = fields.size() > 4 ? fields[4] : std::string();
+        e.birthDate = fields.size() > 5 ? fields[5] : std::string();
+        return true;
+    }
+    return false;
+}
+
+// ================= GENERATOR =================
+namespace {
+
+const uint64_t US_PER_DAY = 24ull * 3600 * 1000000;
+
+const int FIRST_NAME_POOL = 2000;
+const int LAST_NAME_POOL = 8000;
+
+// Distinct made-up words: i written in base 24 with a syllable per digit,
+// at least two syllables long
+const char* const syllables[] = {"ka", "lo", "mi", "ne", "ra", "su", "ti", "vo", "ba", "de", "fi", "gu",
+                                 "ha", "jo", "ku", "le", "ma", "no", "pe", "ri", "sa", "to", "vu", "ze"};
+const size_t SYLLABLES = sizeof(syllables) / sizeof(syllables[0]);
+
+std::string madeUpWord(size_t i)
+{
+    std::string word;
+    size_t value = i + SYLLABLES;
+    while (value) {
+        word += syllables[value % SYLLABLES];
+        value /= SYLLABLES;
+    }
+    return word;
+}
+
+std::string capitalized(std::string word)
+{
+    word[0] = static_cast<char>(word[0] - 'a' + 'A');
+    return word;
+}
+
+std::FILE* openTrace(const std::string& path, const char* what)
+{
+    std::FILE* out = std::fopen(path.c_str(), "w");
+    if (out) std::fprintf(out, "# espritcare trace v1: %s\n", what);
+    return out;
+}
+
+bool closeTrace(std::FILE* out)
+{
+    const bool ok = !std::ferror(out);
+    return std::fclose(out) == 0 && ok;
+}
+
+bool earlier(const Event& a, const Event& b)
+{
+    return a.timeUs < b.timeUs;
+}
+
+} // namespace
+
+WorkloadGenerator::WorkloadGenerator(const WorkloadOptions& options)
+    : options(options),
+      rng(options.seed),
+      visits(options.patients, options.visitSkew),
+      firstNames(FIRST_NAME_POOL, options.nameSkew),
+      lastNames(LAST_NAME_POOL, options.nameSkew),
+      noteLengths(std::max(1, options.maxNoteWords - options.minNoteWords + 1), options.noteLengthSkew),
+      words(options.vocabulary, options.wordSkew)
+{
+    // Popular patients are spread over the registry rather than being the
+    // first ones registered
+    popularity.resize(options.patients);
+    std::iota(popularity.begin(), popularity.end(), 1);
+    std::shuffle(popularity.begin(), popularity.end(), rng);
+
+    names.reserve(options.patients);
+    for (size_t i = 0; i < options.patients; ++i) names.push_back(newName());
+}
+
+int WorkloadGenerator::visitTarget()
+{
+    return popularity[visits(rng) - 1];
+}
+
+std::string WorkloadGenerator::newName()
+{
+    return capitalized(madeUpWord(firstNames(rng) - 1)) + " " +
+           capitalized(madeUpWord(FIRST_NAME_POOL + lastNames(rng) - 1));
+}
+
+std::string WorkloadGenerator::birthDate()
+{
+    char date[16];
+    std::snprintf(date, sizeof(date), "%04d-%02d-%02d", 1935 + static_cast<int>(rng() % 90),
+                  1 + static_cast<int>(rng() % 12), 1 + static_cast<int>(rng() % 28));
+    return date;
+}
+
+const char* WorkloadGenerator::gender()
+{
+    const unsigned roll = rng() % 100;
+    return roll < 49 ? "Male" : roll < 99 ? "Female" : "Other";
+}
+
+std::string WorkloadGenerator::note()
+{
+    const int length = options.minNoteWords + static_cast<int>(noteLengths(rng)) - 1;
+    std::string text;
+    for (int w = 0; w < length; ++w) {
+        if (w) text += ' ';
+        text += madeUpWord(words(rng) - 1);
+    }
+    return text;
+}
+
+// One or two words, sometimes a prefix search ("word*")
+std::string WorkloadGenerator::noteQuery()
+{
+    std::string query = madeUpWord(words(rng) - 1);
+    if (rng() % 3 == 0) query += " " + madeUpWord(words(rng) - 1);
+    if (rng() % 5 == 0) query = query.substr(0, std::max<size_t>(3, query.size() / 2)) + "*";
+    return query;
+}
+
+bool WorkloadGenerator::writeRegistry(const std::string& path)
+{
+    std::FILE* out = std::fopen(path.c_str(), "w");
+    if (!out) return false;
+    std::fprintf(out, "name,gender,birth_date\n");
+    for (const std::string& name : names) {
+        std::fprintf(out, "%s,%s,%s\n", name.c_str(), gender(), birthDate().c_str());
+    }
+    return closeTrace(out);
+}
+
+bool WorkloadGenerator::writeHistory(const std::string& path)
+{
+    std::FILE* out = openTrace(path, "history");
+    if (!out) return false;
+
+    const uint64_t open = static_cast<uint64_t>(options.dayHours * 3600e6);
+    std::vector<Event> day;
+    for (int d = 0; d < options.historyDays; ++d) {
+        day.clear();
+        for (int v = 0; v < options.visitsPerDay; ++v) {
+            Event e;
+            e.timeUs = d * US_PER_DAY + rng() % std::max<uint64_t>(1, open);
+            e.op = Op::AddSession;
+            e.id = visitTarget();
+            e.text = note();
+            day.push_back(std::move(e));
+        }
+        std::sort(day.begin(), day.end(), earlier);
+        for (const Event& e : day) writeEvent(out, e);
+    }
+    return closeTrace(out);
+}
+
+// A day at the front desk. Each visit is the Add Session flow: type part
+// of the name (or the ID), pick the patient, save the notes a minute
+// later, and the dashboard catches up. Other work is spread over the day.
+bool WorkloadGenerator::writeDay(const std::string& path)
+{
+    const uint64_t open = std::max<uint64_t>(1, static_cast<uint64_t>(options.dayHours * 3600e6));
+    std::vector<Event> events;
+    auto at = [&](uint64_t timeUs, Op op, int id, std::string text = std::string()) {
+        Event e;
+        e.timeUs = timeUs;
+        e.op = op;
+        e.id = id;
+        e.text = std::move(text);
+        events.push_back(std::move(e));
+        return &events.back();
+    };
+
+    for (int v = 0; v < options.visitsPerDay; ++v) {
+        const int id = visitTarget();
+        uint64_t t = rng() % open;
+        if (rng() % 10 == 0) {
+            at(t, Op::SearchPatient, 0, std::to_string(id));
+        } else {
+            const std::string& name = names[id - 1];
+            for (size_t typed = 3; typed < name.size(); typed += 2 + rng() % 3) {
+                at(t, Op::TypeAhead, 0, name.substr(0, typed));
+                t += 300000;   // a few keystrokes per debounce
+            }
+            at(t, Op::LookupPatient, id);
+        }
+        t += 60000000;
+        at(t, Op::AddSession, id, note());
+        at(t, Op::AddRecentVisit, id);
+        at(t, Op::Dashboard, 0);
+    }
+    for (int i = 0; i < options.newPatientsPerDay; ++i) {
+        Event* e = at(rng() % open, Op::AddPatient, 0, newName());
+        e->gender = gender();
+        e->birthDate = birthDate();
+    }
+    for (int i = 0; i < options.historyViewsPerDay; ++i) {
+        at(rng() % open, Op::PatientHistory, visitTarget());
+    }
+    for (int i = 0; i < options.noteSearchesPerDay; ++i) {
+        at(rng() % open, Op::SearchNotes, 0, noteQuery());
+    }
+    for (int i = 0; i < options.listPagesPerDay; ++i) {
+        at(rng() % open, Op::ListPage, static_cast<int>(rng() % options.patients), rng() % 2 ? "name" : "recent");
+    }
+
+    std::stable_sort(events.begin(), events.end(), earlier);
+
+    std::FILE* out = openTrace(path, "day");
+    if (!out) return false;
+    for (const Event& e : events) writeEvent(out, e);
+    return closeTrace(out);
+}
+
+} // namespace workload
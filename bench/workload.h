@@ -0,0 +1,150 @@
+// Synthetic clinic workload: a patient registry plus event traces whose
+// visits, note lengths and note words follow Zipf distributions, so load
+// can be sized without real patient data. workload_gen writes the files
+// and replay_bench feeds them through Backend.
+//
+// Files written to one directory:
+//   registry.csv    name,gender,birth_date (what importPatients() reads);
+//                   row k becomes patient ID k on an empty Backend
+//   history.trace   past sessions only, replayed untimed to age the data
+//   day.trace       one clinic day of the full operation mix
+//
+// Trace format: text, one event per line, tab separated,
+//   time_us  op  id  text  [gender  birth_date]
+// with '#' lines ignored. Names and notes are built from letters and
+// spaces only, so fields never need quoting.
+
+#ifndef WORKLOAD_H
+#define WORKLOAD_H
+
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace workload {
+
+// ================= ZIPF SAMPLER =================
+// Ranks 1..n with P(k) proportional to 1 / k^exponent. Rejection-inversion
+// (Hormann & Derflinger): O(1) per sample and no tables, so n can be the
+// whole registry. Any exponent > 0 works, including 1.
+class ZipfSampler
+{
+public:
+    ZipfSampler(uint64_t n, double exponent);
+    uint64_t operator()(std::mt19937_64& rng) const;
+
+private:
+    double h(double x) const;          // x^-exponent
+    double hIntegral(double x) const;  // its antiderivative
+    double hIntegralInverse(double x) const;
+
+    uint64_t n;
+    double exponent;
+    double hIntegralX1;
+    double hIntegralN;
+    double s;
+};
+
+// ================= TRACE EVENTS =================
+// One Backend call, or the handful of calls one screen action makes
+enum class Op : char {
+    AddPatient = 'P',       // text = name, plus gender and birth date
+    LookupPatient = 'G',    // getPatientByID(id): suggestion picked
+    TypeAhead = 'T',        // searchPatients(text, 8) while typing
+    SearchPatient = 'Q',    // searchPatient(text) on Enter
+    AddSession = 'S',       // addSession(id, text)
+    AddRecentVisit = 'R',   // addRecentVisit(id)
+    PatientHistory = 'H',   // getSessionsForPatient(id)
+    SearchNotes = 'N',      // searchNotes(text)
+    Dashboard = 'D',        // recent visits and top 10, as the dashboard shows them
+    ListPage = 'L'          // 20 rows from row `id` in order text ("name" or "recent")
+};
+
+struct Event {
+    uint64_t timeUs = 0;    // from the start of the trace
+    Op op = Op::Dashboard;
+    int id = 0;
+    std::string text;
+    std::string gender;
+    std::string birthDate;
+};
+
+bool isKnownOp(char op);
+const char* opName(Op op);   // the Backend call, e.g. "searchPatients"
+
+void writeEvent(std::FILE* out, const Event& e);
+
+// Reads a trace one event at a time, so a multi-year history never has
+// to fit in memory
+class TraceReader
+{
+public:
+    bool open(const std::string& path);
+    bool next(Event& e);                             // false at the end or on a bad line
+    const std::string& error() const { return message; }
+
+private:
+    std::ifstream in;
+    std::string line;
+    size_t lineNumber = 0;
+    std::string message;
+};
+
+// ================= GENERATOR =================
+struct WorkloadOptions {
+    size_t patients = 100000;
+    int historyDays = 0;           // 3 years = 1095
+    int visitsPerDay = 200;
+    int newPatientsPerDay = 10;
+    int historyViewsPerDay = 50;
+    int noteSearchesPerDay = 20;
+    int listPagesPerDay = 20;
+    double dayHours = 10;
+
+    double visitSkew = 1.0;        // over patients: a few regulars, a long tail
+    double nameSkew = 0.8;         // over the first and last name pools
+    double noteLengthSkew = 1.1;   // over note lengths in words
+    int minNoteWords = 5;
+    int maxNoteWords = 400;
+    double wordSkew = 1.0;         // over the note vocabulary
+    size_t vocabulary = 20000;
+
+    uint64_t seed = 1;
+};
+
+// Everything is derived from the options, so the same options and seed
+// always give the same files
+class WorkloadGenerator
+{
+public:
+    explicit WorkloadGenerator(const WorkloadOptions& options);
+
+    bool writeRegistry(const std::string& path);
+    bool writeHistory(const std::string& path);
+    bool writeDay(const std::string& path);
+
+private:
+    int visitTarget();             // patient ID, Zipf by popularity
+    std::string note();
+    std::string noteQuery();
+    std::string newName();
+    std::string birthDate();
+    const char* gender();
+
+    WorkloadOptions options;
+    std::mt19937_64 rng;
+    ZipfSampler visits;
+    ZipfSampler firstNames;
+    ZipfSampler lastNames;
+    ZipfSampler noteLengths;
+    ZipfSampler words;
+    std::vector<int> popularity;     // rank - 1 -> patient ID
+    std::vector<std::string> names;  // ID - 1 -> name, for search queries
+};
+
+} // namespace workload
+
+#endif // WORKLOAD_H
@@ -0,0 +1,125 @@
+// Writes a synthetic registry and clinic traces for replay_bench (see
+// workload.h for the files). No real patient data is involved: names and
+// notes are made-up words.
+//
+//   workload_gen --out load-2M --patients 2M --history-days 1095 --visits-per-day 2000
+//   replay_bench --dir load-2M --json replay.json
+
+#include "workload.h"
+#include "benchharness.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace {
+
+void usage()
+{
+    std::fprintf(stderr,
+                 "usage: workload_gen --out DIR [options]\n"
+                 "  --patients N              registry size, e.g. 100k or 2M (default 100k)\n"
+                 "  --history-days N          days of past sessions to write (default 0)\n"
+                 "  --visits-per-day N        sessions per day, history and day trace (default 200)\n"
+                 "  --new-per-day N           registrations during the day (default 10)\n"
+                 "  --history-views-per-day N patient histories opened (default 50)\n"
+                 "  --note-searches-per-day N notes searches (default 20)\n"
+                 "  --list-pages-per-day N    View Patients pages (default 20)\n"
+                 "  --visit-skew S            Zipf exponent over patients (default 1.0)\n"
+                 "  --name-skew S             over first/last name pools (default 0.8)\n"
+                 "  --note-length-skew S      over note lengths (default 1.1)\n"
+                 "  --min-note-words N        (default 5)\n"
+                 "  --max-note-words N        (default 400)\n"
+                 "  --word-skew S             over the note vocabulary (default 1.0)\n"
+                 "  --vocabulary N            distinct note words (default 20000)\n"
+                 "  --seed N                  (default 1)\n");
+}
+
+double seconds(std::chrono::steady_clock::time_point since)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - since).count();
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    workload::WorkloadOptions options;
+    std::string dir;
+
+    for (int i = 1; i < argc; ++i) {
+        const char* flag = argv[i];
+        if (i + 1 >= argc) {
+            usage();
+            return 2;
+        }
+        const char* value = argv[++i];
+        auto count = [&]() {
+            std::vector<size_t> parsed = bench::parseSizes(value);
+            return parsed.size() == 1 ? parsed[0] : size_t(0);
+        };
+        auto number = [&]() { return static_cast<int>(std::atoi(value)); };
+        auto skew = [&]() { return std::atof(value); };
+
+        if (std::strcmp(flag, "--out") == 0) dir = value;
+        else if (std::strcmp(flag, "--patients") == 0) options.patients = count();
+        else if (std::strcmp(flag, "--history-days") == 0) options.historyDays = number();
+        else if (std::strcmp(flag, "--visits-per-day") == 0) options.visitsPerDay = number();
+        else if (std::strcmp(flag, "--new-per-day") == 0) options.newPatientsPerDay = number();
+        else if (std::strcmp(flag, "--history-views-per-day") == 0) options.historyViewsPerDay = number();
+        else if (std::strcmp(flag, "--note-searches-per-day") == 0) options.noteSearchesPerDay = number();
+        else if (std::strcmp(flag, "--list-pages-per-day") == 0) options.listPagesPerDay = number();
+        else if (std::strcmp(flag, "--visit-skew") == 0) options.visitSkew = skew();
+        else if (std::strcmp(flag, "--name-skew") == 0) options.nameSkew = skew();
+        else if (std::strcmp(flag, "--note-length-skew") == 0) options.noteLengthSkew = skew();
+        else if (std::strcmp(flag, "--min-note-words") == 0) options.minNoteWords = number();
+        else if (std::strcmp(flag, "--max-note-words") == 0) options.maxNoteWords = number();
+        else if (std::strcmp(flag, "--word-skew") == 0) options.wordSkew = skew();
+        else if (std::strcmp(flag, "--vocabulary") == 0) options.vocabulary = count();
+        else if (std::strcmp(flag, "--seed") == 0) options.seed = std::strtoull(value, nullptr, 10);
+        else {
+            usage();
+            return 2;
+        }
+    }
+
+    if (dir.empty() || options.patients == 0 || options.vocabulary == 0 || options.visitSkew <= 0 ||
+        options.nameSkew <= 0 || options.noteLengthSkew <= 0 || options.wordSkew <= 0 ||
+        options.minNoteWords < 1 || options.maxNoteWords < options.minNoteWords) {
+        usage();
+        return 2;
+    }
+
+    std::error_code ec;
+    std::filesystem::create_directories(dir, ec);
+    const std::string base = dir + "/";
+
+    auto start = std::chrono::steady_clock::now();
+    workload::WorkloadGenerator generator(options);
+
+    if (!generator.writeRegistry(base + "registry.csv")) {
+        std::fprintf(stderr, "cannot write %sregistry.csv\n", base.c_str());
+        return 1;
+    }
+    std::printf("registry.csv   %zu patients (%.1f s)\n", options.patients, seconds(start));
+
+    start = std::chrono::steady_clock::now();
+    if (!generator.writeHistory(base + "history.trace")) {
+        std::fprintf(stderr, "cannot write %shistory.trace\n", base.c_str());
+        return 1;
+    }
+    std::printf("history.trace  %lld sessions over %d days (%.1f s)\n",
+                static_cast<long long>(options.historyDays) * options.visitsPerDay, options.historyDays,
+                seconds(start));
+
+    start = std::chrono::steady_clock::now();
+    if (!generator.writeDay(base + "day.trace")) {
+        std::fprintf(stderr, "cannot write %sday.trace\n", base.c_str());
+        return 1;
+    }
+    std::printf("day.trace      %d visits (%.1f s)\n", options.visitsPerDay, seconds(start));
+    return 0;
+}
@@ -0,0 +1,281 @@
+#include "bulkimport.h"
+#include "backend.h"
+#include "mappedfile.h"
+#include "trace.h"
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <string_view>
+#include <thread>
+
+namespace {
+
+enum Column { COL_NAME, COL_GENDER, COL_BIRTH_DATE, COL_COUNT };
+
+struct ChunkResult {
+    std::vector<Patient> rows;
+    std::vector<ImportError> errors;   // line numbers local to the chunk
+    size_t rejected = 0;
+    size_t lines = 0;
+};
+
+// ---------- Field helpers ----------
+std::string_view trim(std::string_view s) {
+    while (!s.empty() && (s.front() == ' ' || s.front() == '\t')) s.remove_prefix(1);
+    while (!s.empty() && (s.back() == ' ' || s.back() == '\t')) s.remove_suffix(1);
+    return s;
+}
+
+bool equalsIgnoreCase(std::string_view a, const char* b) {
+    if (a.size() != std::strlen(b)) return false;
+    for (size_t i = 0; i < a.size(); ++i) {
+        char c = a[i];
+        if (c >= 'A' && c <= 'Z') c = static_cast<char>(c - 'A' + 'a');
+        if (c != b[i]) return false;
+    }
+    return true;
+}
+
+// Split one line into fields. Quoted fields are unescaped into `scratch`,
+// which is sized up front so the views into it stay valid.
+void splitFields(std::string_view line, char delimiter, std::vector<std::string_view>& fields,
+                 std::string& scratch) {
+    fields.clear();
+    scratch.clear();
+    scratch.reserve(line.size());
+
+    size_t pos = 0;
+    for (;;) {
+        size_t start = pos;
+        while (start < line.size() && line[start] == ' ') ++start;
+
+        if (start < line.size() && line[start] == '"') {
+            const size_t from = scratch.size();
+            size_t i = start + 1;
+            while (i < line.size()) {
+                if (line[i] == '"') {
+                    if (i + 1 < line.size() && line[i + 1] == '"') {
+                        scratch.push_back('"');
+                        i += 2;
+                        continue;
+                    }
+                    ++i;
+                    break;
+                }
+                scratch.push_back(line[i++]);
+            }
+            fields.push_back(std::string_view(scratch).substr(from));
+            pos = line.find(delimiter, i);
+        } else {
+            size_t end = line.find(delimiter, pos);
+            fields.push_back(trim(line.substr(pos, end == std::string_view::npos ? end : end - pos)));
+            pos = end;
+        }
+
+        if (pos == std::string_view::npos) break;
+        ++pos;
+    }
+}
+
+bool validDate(std::string_view s) {
+    if (s.size() != 10 || s[4] != '-' || s[7] != '-') return false;
+    for (size_t i : {0, 1, 2, 3, 5, 6, 8, 9}) {
+        if (s[i] < '0' || s[i] > '9') return false;
+    }
+    int year = (s[0] - '0') * 1000 + (s[1] - '0') * 100 + (s[2] - '0') * 10 + (s[3] - '0');
+    int month = (s[5] - '0') * 10 + (s[6] - '0');
+    int day = (s[8] - '0') * 10 + (s[9] - '0');
+    if (year < 1800 || month < 1 || month > 12 || day < 1) return false;
+
+    static const int daysIn[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    bool leap = (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+    return day <= daysIn[month - 1] + (month == 2 && leap ? 1 : 0);
+}
+
+const char* normalGender(std::string_view s) {
+    if (equalsIgnoreCase(s, "male") || equalsIgnoreCase(s, "m")) return "Male";
+    if (equalsIgnoreCase(s, "female") || equalsIgnoreCase(s, "f")) return "Female";
+    if (equalsIgnoreCase(s, "other")) return "Other";
+    return nullptr;
+}
+
+// ---------- Header ----------
+char guessDelimiter(std::string_view firstLine) {
+    for (char c : {'\t', ',', ';'}) {
+        if (firstLine.find(c) != std::string_view::npos) return c;
+    }
+    return ',';
+}
+
+// Fill `columns` from a header line; false if it does not look like one
+bool readHeader(std::string_view line, char delimiter, int columns[COL_COUNT]) {
+    std::vector<std::string_view> fields;
+    std::string scratch;
+    splitFields(line, delimiter, fields, scratch);
+
+    std::fill(columns, columns + COL_COUNT, -1);
+    for (size_t i = 0; i < fields.size(); ++i) {
+        std::string_view f = fields[i];
+        if (equalsIgnoreCase(f, "name") || equalsIgnoreCase(f, "patient_name") ||
+            equalsIgnoreCase(f, "full_name")) {
+            columns[COL_NAME] = static_cast<int>(i);
+        } else if (equalsIgnoreCase(f, "gender") || equalsIgnoreCase(f, "sex")) {
+            columns[COL_GENDER] = static_cast<int>(i);
+        } else if (equalsIgnoreCase(f, "birth_date") || equalsIgnoreCase(f, "birthdate") ||
+                   equalsIgnoreCase(f, "dob") || equalsIgnoreCase(f, "date_of_birth")) {
+            columns[COL_BIRTH_DATE] = static_cast<int>(i);
+        }
+    }
+    return columns[COL_NAME] >= 0;
+}
+
+// ---------- Chunk parser ----------
+void parseChunk(const char* begin, const char* end, char delimiter, const int columns[COL_COUNT],
+                size_t maxErrors, ChunkResult& out) {
+    // Rough guess of the row count to avoid regrowing: ~32 bytes per row
+    out.rows.reserve(static_cast<size_t>(end - begin) / 32 + 1);
+
+    const int needed = std::max({columns[COL_NAME], columns[COL_GENDER], columns[COL_BIRTH_DATE]}) + 1;
+    std::vector<std::string_view> fields;
+    std::string scratch;
+
+    auto reject = [&](const char* message) {
+        out.rejected++;
+        if (out.errors.size() < maxErrors) out.errors.push_back({out.lines, message});
+    };
+
+    const char* p = begin;
+    while (p < end) {
+        const char* newline = static_cast<const char*>(std::memchr(p, '\n', static_cast<size_t>(end - p)));
+        const char* lineEnd = newline ? newline : end;
+        std::string_view line(p, static_cast<size_t>(lineEnd - p));
+        p = newline ? newline + 1 : end;
+        out.lines++;
+
+        if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+        if (trim(line).empty()) continue;
+
+        splitFields(line, delimiter, fields, scratch);
+        if (static_cast<int>(fields.size()) < needed) {
+            reject("missing columns");
+            continue;
+        }
+
+        std::string_view name = fields[columns[COL_NAME]];
+        if (name.empty()) {
+            reject("name is blank");
+            continue;
+        }
+        const char* gender = normalGender(fields[columns[COL_GENDER]]);
+        if (!gender) {
+            reject("gender must be Male, Female or Other");
+            continue;
+        }
+        std::string_view birthDate = fields[columns[COL_BIRTH_DATE]];
+        if (!validDate(birthDate)) {
+            reject("birth date must be a valid YYYY-MM-DD date");
+            continue;
+        }
+
+        Patient patient;
+        patient.id = 0;
+        patient.name.assign(name.data(), name.size());
+        patient.gender = gender;
+        patient.birth_date.assign(birthDate.data(), birthDate.size());
+        patient.visit_count = 0;
+        out.rows.push_back(std::move(patient));
+    }
+}
+
+} // namespace
+
+ImportResult importPatients(Backend& backend, const std::string& path, const ImportOptions& options) {
+    TRACE_SPAN("backend", "importPatients");
+    ImportResult result;
+
+    MappedFile file;
+    if (!file.open(path)) {
+        result.error = "cannot open " + path;
+        return result;
+    }
+    file.adviseSequential();
+
+    const char* data = file.data();
+    const char* end = data + file.size();
+    if (file.size() >= 3 && std::memcmp(data, "\xEF\xBB\xBF", 3) == 0) data += 3;   // UTF-8 BOM
+    if (data == end) {   // nothing to import is not an error
+        result.firstID = backend.addPatients({});
+        result.ok = true;
+        return result;
+    }
+
+    // === Header ===
+    const char* firstNewline = static_cast<const char*>(std::memchr(data, '\n', static_cast<size_t>(end - data)));
+    std::string_view firstLine(data, static_cast<size_t>((firstNewline ? firstNewline : end) - data));
+    if (!firstLine.empty() && firstLine.back() == '\r') firstLine.remove_suffix(1);
+
+    const char delimiter = options.delimiter ? options.delimiter : guessDelimiter(firstLine);
+    int columns[COL_COUNT] = {COL_NAME, COL_GENDER, COL_BIRTH_DATE};
+    size_t firstLineNumber = 1;
+    if (readHeader(firstLine, delimiter, columns)) {
+        if (columns[COL_GENDER] < 0 || columns[COL_BIRTH_DATE] < 0) {
+            result.error = "header needs name, gender and birth_date columns";
+            return result;
+        }
+        data = firstNewline ? firstNewline + 1 : end;
+        firstLineNumber = 2;
+    } else {
+        columns[COL_NAME] = 0;
+        columns[COL_GENDER] = 1;
+        columns[COL_BIRTH_DATE] = 2;
+    }
+
+    // === Split at line boundaries, one chunk per worker ===
+    unsigned threads = options.threads ? options.threads : std::max(1u, std::thread::hardware_concurrency());
+    const size_t minChunk = 1 << 20;
+    const size_t bytes = static_cast<size_t>(end - data);
+    const size_t chunkCount = std::max<size_t>(1, std::min<size_t>(threads, bytes / minChunk));
+
+    std::vector<const char*> bounds(1, data);
+    for (size_t c = 1; c < chunkCount; ++c) {
+        const char* cut = std::max(data + bytes * c / chunkCount, bounds.back());
+        const char* newline = static_cast<const char*>(std::memchr(cut, '\n', static_cast<size_t>(end - cut)));
+        bounds.push_back(newline ? newline + 1 : end);
+    }
+    bounds.push_back(end);
+
+    // === Parse and validate in parallel ===
+    std::vector<ChunkResult> chunks(chunkCount);
+    std::vector<std::thread> workers;
+    for (size_t c = 1; c < chunkCount; ++c) {
+        workers.emplace_back(parseChunk, bounds[c], bounds[c + 1], delimiter, columns,
+                             options.maxErrors, std::ref(chunks[c]));
+    }
+    parseChunk(bounds[0], bounds[1], delimiter, columns, options.maxErrors, chunks[0]);
+    for (std::thread& t : workers) t.join();
+
+    // === Gather in file order, then insert as one batch ===
+    size_t total = 0;
+    for (const ChunkResult& chunk : chunks) total += chunk.rows.size();
+
+    std::vector<Patient> rows;
+    rows.reserve(total);
+    size_t lineOffset = firstLineNumber;
+    for (ChunkResult& chunk : chunks) {
+        std::move(chunk.rows.begin(), chunk.rows.end(), std::back_inserter(rows));
+        for (ImportError& e : chunk.errors) {
+            if (result.errors.size() >= options.maxErrors) break;
+            e.line += lineOffset - 1;
+            result.errors.push_back(std::move(e));
+        }
+        result.rejected += chunk.rejected;
+        lineOffset += chunk.lines;
+        chunk = ChunkResult();
+    }
+
+    result.imported = rows.size();
+    result.firstID = backend.addPatients(std::move(rows), threads);
+    result.ok = true;
+    return result;
+}
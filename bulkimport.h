@@ -0,0 +1,48 @@
+#ifndef BULKIMPORT_H
+#define BULKIMPORT_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+class Backend;
+
+// ================= BULK PATIENT IMPORT =================
+// Loads a CSV or TSV registry export into a Backend in one go.
+//
+// The file is memory-mapped and split into one chunk per worker at line
+// boundaries; workers parse and validate their chunk in parallel, then
+// every valid row goes through Backend::addPatients() as a single batch.
+//
+// Columns are matched by header name (name; gender/sex; birth_date,
+// birthdate, dob or date_of_birth). Without a recognised header the
+// columns are taken as name, gender, birth_date. Fields may be quoted
+// with "..." ("" inside quotes is a literal quote) but may not span lines.
+//
+// A row is rejected if the name is blank, the gender is not Male, Female
+// or Other (any case), or the birth date is not a real YYYY-MM-DD date.
+
+struct ImportOptions {
+    char delimiter = 0;        // 0 = guess from the first line (tab, comma or semicolon)
+    unsigned threads = 0;      // 0 = one per core
+    size_t maxErrors = 100;    // rejected rows listed individually in the result
+};
+
+struct ImportError {
+    size_t line;               // 1-based line in the file
+    std::string message;
+};
+
+struct ImportResult {
+    bool ok = false;           // false = the file could not be opened or has a bad header
+    std::string error;
+    size_t imported = 0;
+    size_t rejected = 0;
+    int firstID = 0;           // IDs firstID .. firstID + imported - 1
+    std::vector<ImportError> errors;
+};
+
+ImportResult importPatients(Backend& backend, const std::string& path,
+                            const ImportOptions& options = ImportOptions());
+
+#endif // BULKIMPORT_H
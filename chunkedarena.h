@@ -0,0 +1,44 @@
+#ifndef CHUNKEDARENA_H
+#define CHUNKEDARENA_H
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+// ================= CHUNKED ARENA =================
+// Append-only storage in fixed-size chunks. Elements never move once
+// added, so pointers and references to them stay valid for the arena's
+// lifetime, and there is one allocation per ChunkSize elements instead of
+// one per element. Everything is released together when the arena dies.
+template <typename T, size_t ChunkSize = 4096>
+class ChunkedArena
+{
+public:
+    template <typename... Args>
+    T& emplace_back(Args&&... args) {
+        if (chunks.empty() || chunks.back().size() == ChunkSize) {
+            chunks.emplace_back();
+            chunks.back().reserve(ChunkSize);   // never grows past this, so never reallocates
+        }
+        chunks.back().emplace_back(std::forward<Args>(args)...);
+        count++;
+        return chunks.back().back();
+    }
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+
+    T& operator[](size_t i) { return chunks[i / ChunkSize][i % ChunkSize]; }
+    const T& operator[](size_t i) const { return chunks[i / ChunkSize][i % ChunkSize]; }
+
+    // Contiguous runs, for walking the arena chunk by chunk
+    size_t chunkCount() const { return chunks.size(); }
+    const T* chunkData(size_t c) const { return chunks[c].data(); }
+    size_t chunkLength(size_t c) const { return chunks[c].size(); }
+
+private:
+    std::vector<std::vector<T>> chunks;
+    size_t count = 0;
+};
+
+#endif // CHUNKEDARENA_H
@@ -1,8 +1,6 @@
 #include "dashboardwindow.h"
-#include "addsessionwindow.h"
-#include "addpatientwindow.h"
-#include "viewpatientwindow.h"
-#include "mainwindow.h"  // for going back to home
+#include "navigator.h"
+#include "backendsignals.h"
 #include <QLabel>
 #include <QPushButton>
 #include <QVBoxLayout>
@@ -12,98 +10,179 @@
 #include <QTimer>
 #include <QFrame>
 #include "backend.h"
+#include "trace.h"
 
-DashboardWindow::DashboardWindow(Backend* backendPtr, QWidget* parent)
-    : QMainWindow(parent), backend(backendPtr)
+// Item data: the patient's ID on every row, and on the frequent list the
+// visit count the row shows, so a new session can find its rank
+static const int VISITS_ROLE = Qt::UserRole + 1;
+
+static QListWidgetItem* recentItem(const Patient& p)
+{
+    QListWidgetItem* item = new QListWidgetItem(QString("ID %1 - %2")
+                                                    .arg(p.id)
+                                                    .arg(QString::fromStdString(p.name)));
+    item->setData(Qt::UserRole, p.id);
+    return item;
+}
+
+static void setFrequentRow(QListWidgetItem* item, int rank, const Patient& p)
+{
+    item->setText(QString("%1. %2 (%3 visits)")
+                      .arg(rank)
+                      .arg(QString::fromStdString(p.name))
+                      .arg(p.visit_count));
+    item->setData(Qt::UserRole, p.id);
+    item->setData(VISITS_ROLE, p.visit_count);
+}
+
+static QListWidgetItem* frequentItem(int rank, const Patient& p)
+{
+    QListWidgetItem* item = new QListWidgetItem;
+    setFrequentRow(item, rank, p);
+    return item;
+}
+
+// The "nothing yet" line shown in an empty list carries no patient ID
+static bool isPlaceholder(const QListWidgetItem* item)
+{
+    return !item->data(Qt::UserRole).isValid();
+}
+
+DashboardWindow::DashboardWindow(Backend* backendPtr, Navigator* navigatorPtr, QWidget* parent)
+    : QMainWindow(parent), backend(backendPtr), navigator(navigatorPtr)
 {
     setupUi();
     refreshDashboard();  // Load data when dashboard opens
+
+    // From here on only the rows a change touches are updated, whichever
+    // screen made it
+    connect(navigator->changes(), &BackendSignals::sessionAdded, this, &DashboardWindow::onSessionAdded);
+    connect(navigator->changes(), &BackendSignals::recentVisitsChanged, this, &DashboardWindow::onRecentVisitsChanged);
 }
 
 // Refresh dashboard - populate recent and frequent patient lists
 void DashboardWindow::refreshDashboard()
 {
-    // Clear existing items
-    recentList->clear();
-    frequentList->clear();
+    refreshRecent();
+    refreshFrequent();
+}
 
-    // === RECENTLY VISITED PATIENTS ===
-    const std::vector<QueueNode>& recentVisits = backend->getRecentVisits();
+// === RECENTLY VISITED PATIENTS ===
+void DashboardWindow::refreshRecent()
+{
+    TRACE_SPAN("ui", "DashboardWindow::refreshRecent");
+    recentList->clear();
+    std::vector<int> recentVisits = backend->getRecentVisits();  // most recent first
 
     if (recentVisits.empty()) {
         recentList->addItem("No recent visits yet.");
-    } else {
-        // Display in reverse order (most recent first)
-        for (auto it = recentVisits.rbegin(); it != recentVisits.rend(); ++it) {
-            QString item = QString("ID %1 - %2")
-            .arg(it->patientID)
-                .arg(QString::fromStdString(it->patientName));
-            recentList->addItem(item);
-        }
+        return;
+    }
+    for (int patientID : recentVisits) {
+        Patient* p = backend->getPatientByID(patientID);
+        if (p) recentList->addItem(recentItem(*p));
     }
+}
 
-    // === FREQUENTLY VISITED PATIENTS ===
-    std::vector<Patient> frequentPatients = backend->getFrequentlyVisited();
+// === FREQUENTLY VISITED PATIENTS ===
+// Top 10 straight from the backend's visit ranking, no copy or sort
+void DashboardWindow::refreshFrequent()
+{
+    TRACE_SPAN("ui", "DashboardWindow::refreshFrequent");
+    frequentList->clear();
+    std::vector<const Patient*> frequentPatients = backend->getTopVisited(FREQUENT_SHOWN);
 
     if (frequentPatients.empty()) {
-        frequentList->addItem("No patients yet.");
-    } else {
-        // Show top 10 most frequent visitors
-        int count = 0;
-        for (const auto& p : frequentPatients) {
-            if (count >= 10) break;  // Limit to top 10
-            if (p.visit_count == 0) continue;  // Skip patients with no visits
-
-            QString item = QString("%1. %2 (%3 visits)")
-                               .arg(count + 1)
-                               .arg(QString::fromStdString(p.name))
-                               .arg(p.visit_count);
-            frequentList->addItem(item);
-            count++;
+        frequentList->addItem("No frequent visitors yet.");
+        return;
+    }
+    for (const Patient* p : frequentPatients) {
+        frequentList->addItem(frequentItem(frequentList->count() + 1, *p));
+    }
+}
+
+// A visit moves the patient to the top of the recent list; a full list
+// forgets its least recent row, like the backend's ring does
+void DashboardWindow::onRecentVisitsChanged(int patientID)
+{
+    TRACE_SPAN("ui", "DashboardWindow::onRecentVisitsChanged");
+    if (patientID < 0) {
+        refreshRecent();   // capacity changed
+        return;
+    }
+    Patient* p = backend->getPatientByID(patientID);
+    if (!p) return;
+
+    for (int row = 0; row < recentList->count(); ++row) {
+        QListWidgetItem* item = recentList->item(row);
+        if (isPlaceholder(item) || item->data(Qt::UserRole).toInt() == patientID) {
+            delete recentList->takeItem(row);
+            break;
         }
+    }
+    recentList->insertItem(0, recentItem(*p));
+
+    while (recentList->count() > static_cast<int>(backend->recentVisitCount())) {
+        delete recentList->takeItem(recentList->count() - 1);
+    }
+}
+
+// Mirrors VisitRanking::increment(): the patient trades places with the
+// first patient at its old count and then ends the bucket one count up.
+// At most two rows change, or one row joins at the bottom.
+void DashboardWindow::onSessionAdded(int sessionID, int patientID)
+{
+    TRACE_SPAN("ui", "DashboardWindow::onSessionAdded");
+    Q_UNUSED(sessionID);
+    const Patient* p = backend->getPatientByID(patientID);
+    if (!p) return;
+    const int previous = p->visit_count - 1;
+
+    if (frequentList->count() == 1 && isPlaceholder(frequentList->item(0))) {
+        delete frequentList->takeItem(0);
+    }
 
-        if (count == 0) {
-            frequentList->addItem("No frequent visitors yet.");
+    const int rows = frequentList->count();
+    int front = rows;   // first row at the old count
+    int row = rows;     // the patient's own row
+    for (int i = 0; i < rows; ++i) {
+        QListWidgetItem* item = frequentList->item(i);
+        if (front == rows && item->data(VISITS_ROLE).toInt() == previous) front = i;
+        if (item->data(Qt::UserRole).toInt() == patientID) {
+            row = i;
+            break;
         }
     }
+
+    // Everyone listed has more visits; there may be room at the bottom
+    if (front == rows) {
+        if (rows < FREQUENT_SHOWN) frequentList->addItem(frequentItem(rows + 1, *p));
+        return;
+    }
+
+    // The front patient takes the patient's old row; for a patient who was
+    // not listed that row is below the top ones, so it simply drops out
+    if (row < rows && row != front) {
+        const Patient* swapped = backend->getPatientByID(frequentList->item(front)->data(Qt::UserRole).toInt());
+        if (swapped) setFrequentRow(frequentList->item(row), row + 1, *swapped);
+    }
+    setFrequentRow(frequentList->item(front), front + 1, *p);
 }
 
 void DashboardWindow::setupUi()
 {
+    TRACE_SPAN("ui", "DashboardWindow::setupUi");
     // Central widget for the entire window
     QWidget *central = new QWidget(this);
     setCentralWidget(central);
 
     // Set a soft, smooth gradient background (same tone as Main Window)
-    central->setStyleSheet(R"(
-        QWidget {
-            background: qlineargradient(spread:pad, x1:0, y1:0, x2:1, y2:1,
-                        stop:0 #f3f7fc, stop:1 #d6e6f5);
-        }
-    )");
+    central->setObjectName("screen");
 
     // ---------- LEFT SIDE MENU ----------
     QFrame *sidePanel = new QFrame(central);
     sidePanel->setFixedWidth(220);
-    sidePanel->setStyleSheet(R"(
-        QFrame {
-            background-color: #203040;
-            border-top-right-radius: 16px;
-            border-bottom-right-radius: 16px;
-        }
-        QPushButton {
-            background-color: transparent;
-            color: white;
-            border: none;
-            text-align: left;
-            padding: 10px 20px;
-            font-size: 11pt;
-        }
-        QPushButton:hover {
-            background-color: #2b7de9;
-            border-radius: 6px;
-        }
-    )");
+    sidePanel->setObjectName("sidePanel");
 
     QVBoxLayout *sideLayout = new QVBoxLayout(sidePanel);
     sideLayout->setAlignment(Qt::AlignTop);
@@ -111,7 +190,7 @@ void DashboardWindow::setupUi()
     sideLayout->setSpacing(12);
 
     QLabel *menuTitle = new QLabel("Menu");
-    menuTitle->setStyleSheet("color: white; font-weight: bold; font-size: 14pt;");
+    menuTitle->setObjectName("menuTitle");
     sideLayout->addWidget(menuTitle);
 
     // Sidebar buttons
@@ -135,32 +214,19 @@ void DashboardWindow::setupUi()
 
     // Greeting Title
     greetingLabel = new QLabel("Hey there, Welcome Back!");
-    greetingLabel->setStyleSheet(R"(
-        QLabel {
-            font-size: 26px;
-            font-weight: bold;
-            color: #1f2f45;
-            background: transparent;  /* makes it blend with gradient */
-        }
-    )");
+    greetingLabel->setObjectName("greeting");
     mainLayout->addWidget(greetingLabel, 0, Qt::AlignLeft);
 
     // Date and Time label
     dateTimeLabel = new QLabel;
-    dateTimeLabel->setStyleSheet(R"(
-        QLabel {
-            font-size: 11pt;
-            color: #4a5e72;
-            background: transparent;  /* blends perfectly */
-        }
-    )");
+    dateTimeLabel->setObjectName("dateTime");
     mainLayout->addWidget(dateTimeLabel, 0, Qt::AlignLeft);
 
     // Line separator
     QFrame *line = new QFrame;
     line->setFrameShape(QFrame::HLine);
     line->setFrameShadow(QFrame::Sunken);
-    line->setStyleSheet("color: #cfd9e6;");
+    line->setObjectName("separator");
     mainLayout->addWidget(line);
 
     // Layout for Recently & Frequently Visited Patients
@@ -172,17 +238,11 @@ void DashboardWindow::setupUi()
     QVBoxLayout *recentLayout = new QVBoxLayout(recentWidget);
 
     QLabel *recentLabel = new QLabel("🕒 Recently Visited Patients");
-    recentLabel->setStyleSheet("font-size: 12pt; font-weight: bold; color: #1f2f45; background: transparent;");
+    recentLabel->setObjectName("sectionTitle");
     recentLayout->addWidget(recentLabel);
 
     recentList = new QListWidget;
-    recentList->setStyleSheet(R"(
-        QListWidget {
-            background: #ffffff;
-            border: 1px solid #cfd9e6;
-            border-radius: 8px;
-        }
-    )");
+    recentList->setObjectName("dashboardList");
     recentLayout->addWidget(recentList);
     patientLayout->addWidget(recentWidget);
 
@@ -191,17 +251,11 @@ void DashboardWindow::setupUi()
     QVBoxLayout *freqLayout = new QVBoxLayout(freqWidget);
 
     QLabel *freqLabel = new QLabel("⭐ Frequently Visited Patients");
-    freqLabel->setStyleSheet("font-size: 12pt; font-weight: bold; color: #1f2f45; background: transparent;");
+    freqLabel->setObjectName("sectionTitle");
     freqLayout->addWidget(freqLabel);
 
     frequentList = new QListWidget;
-    frequentList->setStyleSheet(R"(
-        QListWidget {
-            background: #ffffff;
-            border: 1px solid #cfd9e6;
-            border-radius: 8px;
-        }
-    )");
+    frequentList->setObjectName("dashboardList");
     freqLayout->addWidget(frequentList);
     patientLayout->addWidget(freqWidget);
 
@@ -243,36 +297,24 @@ void DashboardWindow::updateDateTime()
 
 void DashboardWindow::onAddPatientClicked()
 {
-    AddPatientWindow *addWindow = new AddPatientWindow(backend, nullptr);  // No parent
-    addWindow->setAttribute(Qt::WA_DeleteOnClose);
-    addWindow->show();
-    this->hide();
+    navigator->go(Screen::AddPatient);
 }
 
 void DashboardWindow::onAddSessionClicked()
 {
-    AddSessionWindow *addSession = new AddSessionWindow(backend, nullptr);  // No parent
-    addSession->setAttribute(Qt::WA_DeleteOnClose);
-    addSession->show();
-    this->hide();
+    navigator->go(Screen::AddSession);
 }
 
 
 void DashboardWindow::onViewPatientsClicked()
 {
-    ViewPatientWindow *viewPatients = new ViewPatientWindow(backend, nullptr);  // No parent
-    viewPatients->setAttribute(Qt::WA_DeleteOnClose);
-    viewPatients->show();
-    this->hide();
+    navigator->go(Screen::ViewPatients);
 }
 
 
 // Go back to the welcome screen (MainWindow)
 void DashboardWindow::onGoBackClicked()
 {
-    MainWindow *mainWin = new MainWindow(backend, nullptr);  // No parent
-    mainWin->setAttribute(Qt::WA_DeleteOnClose);
-    mainWin->show();
-    this->close();
+    navigator->go(Screen::Welcome);
 }
 
@@ -2,6 +2,7 @@
 #include <QMainWindow>
 #include "backend.h"
 
+class Navigator;
 class QLabel;
 class QPushButton;
 class QListWidget;
@@ -11,8 +12,10 @@ class DashboardWindow : public QMainWindow
 {
     Q_OBJECT
 public:
-    explicit DashboardWindow(Backend* backend, QWidget* parent = nullptr);
-    void refreshDashboard();
+    explicit DashboardWindow(Backend* backend, Navigator* navigator, QWidget* parent = nullptr);
+    void refreshDashboard();   // rebuild both lists from the backend
+
+    static const int FREQUENT_SHOWN = 10;
 
 private slots:
     void updateDateTime();
@@ -20,14 +23,21 @@ private slots:
     void onAddSessionClicked();
     void onViewPatientsClicked();
     void onGoBackClicked();
+
+    // Backend changes, applied to the affected rows only
+    void onSessionAdded(int sessionID, int patientID);
+    void onRecentVisitsChanged(int patientID);
 private:
     void setupUi();
+    void refreshRecent();
+    void refreshFrequent();
     QLabel *greetingLabel;
     QLabel *dateTimeLabel;
     QTimer *timer;
     QListWidget *recentList;
     QListWidget *frequentList;
     Backend* backend;
+    Navigator* navigator;
 
 };
 
@@ -0,0 +1,187 @@
+#include "diagnosticsdialog.h"
+#include "navigator.h"
+#include "stallwatchdog.h"
+#include "trace.h"
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QLabel>
+#include <QListWidget>
+#include <QTableWidget>
+#include <QHeaderView>
+#include <QPushButton>
+#include <QTimer>
+
+static const int BAR_WIDTH = 30;   // characters for the fullest bucket
+
+static QString screenName(Screen screen)
+{
+    switch (screen) {
+    case Screen::Welcome:      return "Welcome";
+    case Screen::Dashboard:    return "Dashboard";
+    case Screen::AddPatient:   return "Add Patient";
+    case Screen::AddSession:   return "Add Session";
+    case Screen::ViewPatients: return "View Patients";
+    }
+    return "?";
+}
+
+// "<= 5 ms", or "> 5000 ms" for the open-ended last bucket
+static QString bucketLabel(int bucket)
+{
+    if (bucket == LoopLatencyHistogram::BUCKETS - 1) {
+        return QString("> %1 ms").arg(LoopLatencyHistogram::BUCKET_LIMITS_MS[bucket - 1]);
+    }
+    return QString("<= %1 ms").arg(LoopLatencyHistogram::BUCKET_LIMITS_MS[bucket]);
+}
+
+DiagnosticsDialog::DiagnosticsDialog(Navigator* navigatorPtr, StallWatchdog* watchdogPtr, QWidget* parent)
+    : QDialog(parent), navigator(navigatorPtr), watchdog(watchdogPtr)
+{
+    setupUi();
+
+    refreshTimer = new QTimer(this);
+    refreshTimer->setInterval(1000);
+    connect(refreshTimer, &QTimer::timeout, this, &DiagnosticsDialog::refresh);
+}
+
+void DiagnosticsDialog::setupUi()
+{
+    TRACE_SPAN("ui", "DiagnosticsDialog::setupUi");
+    setObjectName("screen");
+
+    QVBoxLayout* mainLayout = new QVBoxLayout(this);
+    mainLayout->setContentsMargins(24, 24, 24, 24);
+    mainLayout->setSpacing(12);
+
+    // --- Event-loop latency ---
+    QLabel* latencyTitle = new QLabel("Event-loop latency");
+    latencyTitle->setObjectName("sectionTitle");
+    mainLayout->addWidget(latencyTitle);
+
+    summaryLabel = new QLabel;
+    summaryLabel->setObjectName("fieldLabel");
+    summaryLabel->setWordWrap(true);
+    mainLayout->addWidget(summaryLabel);
+
+    latencyTable = new QTableWidget(LoopLatencyHistogram::BUCKETS, 3);
+    latencyTable->setObjectName("patientTable");
+    latencyTable->setHorizontalHeaderLabels({"Heartbeat late by", "Beats", ""});
+    latencyTable->verticalHeader()->hide();
+    latencyTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    latencyTable->setSelectionMode(QAbstractItemView::NoSelection);
+    latencyTable->horizontalHeader()->setStretchLastSection(true);
+    for (int b = 0; b < LoopLatencyHistogram::BUCKETS; ++b) {
+        latencyTable->setItem(b, 0, new QTableWidgetItem(bucketLabel(b)));
+        latencyTable->setItem(b, 1, new QTableWidgetItem);
+        latencyTable->setItem(b, 2, new QTableWidgetItem);
+    }
+    mainLayout->addWidget(latencyTable, 3);
+
+    // --- Stalls and screen switches ---
+    QHBoxLayout* listsLayout = new QHBoxLayout;
+    listsLayout->setSpacing(16);
+
+    QVBoxLayout* stallLayout = new QVBoxLayout;
+    QLabel* stallTitle = new QLabel("Stalls (latest first)");
+    stallTitle->setObjectName("sectionTitle");
+    stallList = new QListWidget;
+    stallList->setObjectName("dashboardList");
+    stallLayout->addWidget(stallTitle);
+    stallLayout->addWidget(stallList);
+    listsLayout->addLayout(stallLayout, 2);
+
+    QVBoxLayout* switchLayout = new QVBoxLayout;
+    QLabel* switchTitle = new QLabel("Screen switches (latest first)");
+    switchTitle->setObjectName("sectionTitle");
+    switchList = new QListWidget;
+    switchList->setObjectName("dashboardList");
+    switchLayout->addWidget(switchTitle);
+    switchLayout->addWidget(switchList);
+    listsLayout->addLayout(switchLayout, 1);
+
+    mainLayout->addLayout(listsLayout, 2);
+
+    // --- Buttons ---
+    QHBoxLayout* buttonLayout = new QHBoxLayout;
+    QPushButton* saveTraceBtn = new QPushButton("Save Trace");
+    saveTraceBtn->setObjectName("primaryButton");
+    saveTraceBtn->setProperty("compact", true);
+    saveTraceBtn->setFixedHeight(38);
+    QPushButton* closeBtn = new QPushButton("Close");
+    closeBtn->setObjectName("secondaryButton");
+    closeBtn->setFixedHeight(38);
+    buttonLayout->addStretch();
+    buttonLayout->addWidget(saveTraceBtn);
+    buttonLayout->addWidget(closeBtn);
+    mainLayout->addLayout(buttonLayout);
+
+    connect(saveTraceBtn, &QPushButton::clicked, navigator, &Navigator::saveTrace);
+    connect(closeBtn, &QPushButton::clicked, this, &QDialog::close);
+
+    setWindowTitle("EspritCare - Diagnostics");
+    resize(760, 620);
+}
+
+void DiagnosticsDialog::showEvent(QShowEvent* event)
+{
+    refresh();
+    refreshTimer->start();
+    QDialog::showEvent(event);
+}
+
+void DiagnosticsDialog::hideEvent(QHideEvent* event)
+{
+    refreshTimer->stop();
+    QDialog::hideEvent(event);
+}
+
+void DiagnosticsDialog::refresh()
+{
+    // === Latency histogram ===
+    if (!watchdog) {
+        summaryLabel->setText("The stall watchdog is not running.");
+    } else {
+        const LoopLatencyHistogram& latency = watchdog->latency();
+        const qint64 now = watchdog->nowSeconds();
+        const QVector<quint64> counts = latency.counts(now);
+        quint64 fullest = 1;
+        for (quint64 c : counts) fullest = qMax(fullest, c);
+
+        for (int b = 0; b < LoopLatencyHistogram::BUCKETS; ++b) {
+            latencyTable->item(b, 1)->setText(QString::number(counts[b]));
+            const int width = counts[b] ? qMax(1, static_cast<int>(BAR_WIDTH * counts[b] / fullest)) : 0;
+            latencyTable->item(b, 2)->setText(QString(width, QChar(0x2588)));
+        }
+        summaryLabel->setText(QString("Last %1 min, stall threshold %2 ms, p50 <= %3 ms, p99 <= %4 ms, worst %5 ms")
+                                  .arg(LoopLatencyHistogram::PERIODS * LoopLatencyHistogram::PERIOD_SECONDS / 60)
+                                  .arg(watchdog->thresholdMs())
+                                  .arg(latency.percentile(0.50, now))
+                                  .arg(latency.percentile(0.99, now))
+                                  .arg(latency.maxMs(now), 0, 'f', 0));
+    }
+
+    // === Stalls ===
+    stallList->clear();
+    if (watchdog) {
+        const std::deque<Stall> stalls = watchdog->stalls();
+        for (auto it = stalls.rbegin(); it != stalls.rend(); ++it) {
+            stallList->addItem(QString("%1  %2 ms%3\n%4")
+                                   .arg(it->when.toString("hh:mm:ss"))
+                                   .arg(it->ms, 0, 'f', 0)
+                                   .arg(it->ongoing ? " and counting" : "")
+                                   .arg(it->running));
+        }
+    }
+    if (stallList->count() == 0) stallList->addItem("No stalls.");
+
+    // === Screen switches ===
+    switchList->clear();
+    const QVector<ScreenSwitch>& switches = navigator->switchHistory();
+    for (auto it = switches.rbegin(); it != switches.rend(); ++it) {
+        switchList->addItem(QString("%1  %2 ms%3")
+                                .arg(screenName(it->screen))
+                                .arg(it->ms, 0, 'f', 1)
+                                .arg(it->built ? "  (built)" : ""));
+    }
+    if (switchList->count() == 0) switchList->addItem("No switches yet.");
+}
@@ -0,0 +1,38 @@
+#pragma once
+#include <QDialog>
+
+class Navigator;
+class StallWatchdog;
+class QLabel;
+class QListWidget;
+class QTableWidget;
+class QTimer;
+
+// ================= DIAGNOSTICS PANEL =================
+// Hidden support panel, opened with Ctrl+Shift+D: event-loop latency over
+// the watchdog's rolling window, the stalls it caught and what was running,
+// the latest screen switches, and a button to save the trace. Refreshes
+// once a second while open.
+class DiagnosticsDialog : public QDialog
+{
+    Q_OBJECT
+public:
+    DiagnosticsDialog(Navigator* navigator, StallWatchdog* watchdog, QWidget* parent = nullptr);
+
+protected:
+    void showEvent(QShowEvent* event) override;
+    void hideEvent(QHideEvent* event) override;
+
+private:
+    void setupUi();
+    void refresh();
+
+    Navigator* navigator;
+    StallWatchdog* watchdog;   // null if it is not running
+
+    QLabel* summaryLabel;
+    QTableWidget* latencyTable;
+    QListWidget* stallList;
+    QListWidget* switchList;
+    QTimer* refreshTimer;
+};
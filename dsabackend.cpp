@@ -1,23 +1,32 @@
 #include "backend.h"
+#include "trace.h"
 #include <ctime>
 #include <algorithm>
 #include <cctype>
+#include <mutex>
 
-Backend::Backend() {
+Backend::Backend() : recentVisits(RECENT_VISIT_MAX) {
     sessionHead = nullptr;
     sessionTail = nullptr;
 }
 
 std::string Backend::currentDate() const {
     time_t t = time(nullptr);
-    tm* now = localtime(&t);
-    char buffer[11];
-    strftime(buffer, sizeof(buffer), "%Y-%m-%d", now);
-    return std::string(buffer);
+
+    // localtime() is slow; within the same second the answer cannot change
+    if (t != cachedDateTime) {
+        tm* now = localtime(&t);
+        char buffer[11];
+        strftime(buffer, sizeof(buffer), "%Y-%m-%d", now);
+        cachedDate = buffer;
+        cachedDateTime = t;
+    }
+    return cachedDate;
 }
 
 // ================= PATIENT =================
 Patient Backend::addPatient(const std::string& name, const std::string& gender, const std::string& birth_date) {
+    TRACE_SPAN("backend", "addPatient");
     Patient p;
     p.id = globalPatientID++;
     p.name = name;
@@ -25,99 +34,303 @@ Patient Backend::addPatient(const std::string& name, const std::string& gender,
     p.birth_date = birth_date;
     p.visit_count = 0;
 
-    allPatients.push_back(p);
-    return p;
+    const Patient& stored = insertPatient(std::move(p));
+    if (journal) journal->appendPatient(stored);
+    TRACE_COUNTER("backend", "patients", static_cast<int64_t>(allPatients.size()));
+    for (BackendObserver* o : observers) o->onPatientsAdded(stored.id, 1);
+    return stored;
 }
 
-Patient* Backend::getPatientByID(int id) {
-    for (auto &p : allPatients) {
-        if (p.id == id) return &p;
+// Store a patient and register it in every index
+Patient& Backend::insertPatient(Patient p) {
+    std::unique_lock<std::shared_mutex> lock(patientMutex);
+
+    // === Register in the ID index ===
+    if (p.id >= static_cast<int>(patientSlots.size())) {
+        patientSlots.resize(p.id + 1, -1);
     }
-    return nullptr;
+    patientSlots[p.id] = static_cast<int>(allPatients.size());
+
+    // === Register in the name index ===
+    nameIndex.add(static_cast<int>(allPatients.size()), p.name);
+
+    // === Register in the visit ranking and sort orders ===
+    visitRanking.add(static_cast<int>(allPatients.size()));
+    nameOrder.add(static_cast<int>(allPatients.size()), nameIndex);
+    recencyOrder.addPatient(static_cast<int>(allPatients.size()));
+
+    allPatients.push_back(std::move(p));
+    revisionCount++;
+    return allPatients.back();
+}
+
+int Backend::addPatients(std::vector<Patient> rows, unsigned threads) {
+    TRACE_SPAN("backend", "addPatients");
+    const int firstID = globalPatientID;
+    if (rows.empty()) return firstID;
+
+    for (Patient& p : rows) {
+        p.id = globalPatientID++;
+        p.visit_count = 0;
+    }
+    if (journal) journal->appendPatients(rows);
+
+    std::unique_lock<std::shared_mutex> lock(patientMutex);
+    const int firstSlot = static_cast<int>(allPatients.size());
+    const size_t count = rows.size();
+
+    // === Register in the ID index ===
+    if (static_cast<int>(patientSlots.size()) < globalPatientID) {
+        patientSlots.resize(globalPatientID, -1);
+    }
+    for (size_t i = 0; i < rows.size(); ++i) {
+        patientSlots[rows[i].id] = firstSlot + static_cast<int>(i);
+    }
+
+    // === Register in the name index, in parallel ===
+    std::vector<std::string_view> names;
+    names.reserve(rows.size());
+    for (const Patient& p : rows) names.push_back(p.name);
+    nameIndex.addBatch(firstSlot, names, threads);
+
+    // === Register in the visit ranking and sort orders ===
+    for (size_t i = 0; i < rows.size(); ++i) {
+        visitRanking.add(firstSlot + static_cast<int>(i));
+        recencyOrder.addPatient(firstSlot + static_cast<int>(i));
+    }
+    nameOrder.addBatch(firstSlot, rows.size(), nameIndex);
+
+    for (Patient& p : rows) allPatients.push_back(std::move(p));
+    revisionCount++;
+    lock.unlock();
+    TRACE_COUNTER("backend", "patients", static_cast<int64_t>(allPatients.size()));
+
+    // One notification for the whole batch
+    for (BackendObserver* o : observers) o->onPatientsAdded(firstID, count);
+    return firstID;
+}
+
+Patient* Backend::getPatientByID(int id) {
+    if (id < 0 || id >= static_cast<int>(patientSlots.size())) return nullptr;
+
+    int slot = patientSlots[id];
+    if (slot < 0) return nullptr;
+    return &allPatients[slot];
 }
 
 // Search patient by ID (if numeric) or by name (partial match, case-insensitive)
 Patient* Backend::searchPatient(const std::string& searchTerm) {
-    if (searchTerm.empty()) return nullptr;
+    TRACE_SPAN("backend", "searchPatient");
+    std::vector<Patient*> matches = searchPatients(searchTerm, 1);
+    return matches.empty() ? nullptr : matches.front();
+}
+
+// All patients matching the term, best match first (see NameIndex::search)
+std::vector<Patient*> Backend::searchPatients(const std::string& searchTerm, size_t limit,
+                                              const std::atomic<bool>* cancelled) {
+    TRACE_SPAN("backend", "searchPatients");
+    std::vector<Patient*> result;
+    if (searchTerm.empty()) return result;
 
     // Try to search by ID first (if searchTerm is numeric)
-    bool isNumeric = true;
+    bool isNumeric = searchTerm.size() <= 9;
     for (char c : searchTerm) {
-        if (!isdigit(c)) {
+        if (!isdigit(static_cast<unsigned char>(c))) {
             isNumeric = false;
             break;
         }
     }
 
+    std::shared_lock<std::shared_mutex> lock(patientMutex);
+
     if (isNumeric) {
-        int id = std::stoi(searchTerm);
-        return getPatientByID(id);
+        Patient* p = getPatientByID(std::stoi(searchTerm));
+        if (p) result.push_back(p);
+        return result;
     }
 
-    // Search by name (case-insensitive partial match)
-    std::string lowerSearch = searchTerm;
-    std::transform(lowerSearch.begin(), lowerSearch.end(), lowerSearch.begin(), ::tolower);
-
-    for (auto &p : allPatients) {
-        std::string lowerName = p.name;
-        std::transform(lowerName.begin(), lowerName.end(), lowerName.begin(), ::tolower);
-
-        if (lowerName.find(lowerSearch) != std::string::npos) {
-            return &p;
-        }
+    // Search by name through the trigram index
+    for (int slot : nameIndex.search(searchTerm, limit, cancelled)) {
+        result.push_back(&allPatients[slot]);
     }
-
-    return nullptr;  // Not found
+    return result;
 }
 
 std::vector<Patient> Backend::getAllPatients() const {
-    return allPatients;
+    TRACE_SPAN("backend", "getAllPatients");
+    return std::vector<Patient>(allPatients.begin(), allPatients.end());
 }
 
 std::vector<Patient> Backend::getFrequentlyVisited() const {
-    std::vector<Patient> sortedPatients = allPatients;
-    std::sort(sortedPatients.begin(), sortedPatients.end(), [](const Patient& a, const Patient& b){
-        return a.visit_count > b.visit_count;
-    });
+    TRACE_SPAN("backend", "getFrequentlyVisited");
+    std::vector<Patient> sortedPatients;
+    sortedPatients.reserve(visitRanking.size());
+    for (size_t rank = 0; rank < visitRanking.size(); ++rank) {
+        sortedPatients.push_back(allPatients[visitRanking.slotAt(rank)]);
+    }
     return sortedPatients;
 }
 
+std::vector<const Patient*> Backend::getTopVisited(size_t k) const {
+    TRACE_SPAN("backend", "getTopVisited");
+    std::vector<const Patient*> top;
+    for (size_t rank = 0; rank < visitRanking.size() && top.size() < k; ++rank) {
+        if (visitRanking.countAt(rank) == 0) break;  // the rest have no visits either
+        top.push_back(&allPatients[visitRanking.slotAt(rank)]);
+    }
+    return top;
+}
+
 
 // ================= SESSION =================
 
-Session Backend::addSession(int patientID, const std::string& notes) {
+Session Backend::addSession(int patientID, const std::string& notes, const std::string& recordingHash) {
+    TRACE_SPAN("backend", "addSession");
     Session s;
     s.session_id = globalSessionID++;
     s.patientID = patientID;
     s.date = currentDate();
     s.notes = notes;
+    s.recording_hash = recordingHash;
 
-    allSessions.push_back(s);
+    const Session& stored = insertSession(std::move(s));
+    if (journal) journal->appendSession(stored);
+    TRACE_COUNTER("backend", "sessions", static_cast<int64_t>(sessionArena.size()));
+    for (BackendObserver* o : observers) o->onSessionAdded(stored);
+    return stored;
+}
 
-    // === Insert into Linked List ===
-    SessionNode* newNode = new SessionNode{ s, nullptr };
+// Store a session and link it into the clinic list and its patient's chain
+const Session& Backend::insertSession(Session s) {
+    // === Store the session once, as a node in the arena ===
+    SessionNode& node = sessionArena.emplace_back();
+    node.data = std::move(s);
+    node.next = nullptr;
+    node.nextOfPatient = nullptr;
+    int patientID = node.data.patientID;
+    notesIndex.add(static_cast<uint32_t>(sessionArena.size() - 1), node.data.notes);
 
+    // === Insert into Linked List ===
     if (!sessionHead) {
-        sessionHead = sessionTail = newNode;
+        sessionHead = sessionTail = &node;
     } else {
-        sessionTail->next = newNode;
-        sessionTail = newNode;
+        sessionTail->next = &node;
+        sessionTail = &node;
     }
 
     // === Increment visit count ===
     Patient* p = getPatientByID(patientID);
-    if (p) p->visit_count++;
+    recencyOrder.addSession(p ? patientSlots[patientID] : -1);
+    if (p) {
+        int slot = patientSlots[patientID];
+        p->visit_count++;
+        visitRanking.increment(slot);
+
+        // === Append to the patient's session chain ===
+        if (slot >= static_cast<int>(sessionChains.size())) {
+            sessionChains.resize(slot + 1);
+        }
+        SessionChain& chain = sessionChains[slot];
+        if (!chain.last) chain.first = &node;
+        else chain.last->nextOfPatient = &node;
+        chain.last = &node;
+        chain.count++;
+    }
+
+    revisionCount++;
+    return node.data;
+}
+
+// ================= SORT ORDERS =================
+const Patient& Backend::patientAt(size_t row, PatientOrder order) const {
+    switch (order) {
+    case PatientOrder::Name:
+        return allPatients[nameOrder.slotAt(row)];
+    case PatientOrder::RecentVisit:
+        if (row < recencyOrder.visitedCount()) {
+            const Session& latest = sessionArena[recencyOrder.latestSessionAt(row)].data;
+            return allPatients[patientSlots[latest.patientID]];
+        }
+        return allPatients[recencyOrder.unvisitedAt(row)];
+    case PatientOrder::Registration:
+        break;
+    }
+    return allPatients[row];
+}
+
+size_t Backend::rowOf(int patientID, PatientOrder order) const {
+    if (patientID < 0 || patientID >= static_cast<int>(patientSlots.size())) return allPatients.size();
+    int slot = patientSlots[patientID];
+    if (slot < 0) return allPatients.size();
+
+    switch (order) {
+    case PatientOrder::Name:
+        return nameOrder.rowOf(slot, nameIndex);
+    case PatientOrder::RecentVisit:
+        return recencyOrder.rowOf(slot);
+    case PatientOrder::Registration:
+        break;
+    }
+    return static_cast<size_t>(slot);
+}
 
-    return s;
+// Sessions in the order they were added, straight from the arena
+std::vector<Session> Backend::getAllSessions() const {
+    TRACE_SPAN("backend", "getAllSessions");
+    std::vector<Session> result;
+    result.reserve(sessionArena.size());
+    for (size_t i = 0; i < sessionArena.size(); ++i) {
+        result.push_back(sessionArena[i].data);
+    }
+    return result;
 }
 
-const std::vector<Session>& Backend::getAllSessions() const {
-    return allSessions;
+const SessionChain* Backend::chainFor(int patientID) const {
+    if (patientID < 0 || patientID >= static_cast<int>(patientSlots.size())) return nullptr;
+
+    int slot = patientSlots[patientID];
+    if (slot < 0 || slot >= static_cast<int>(sessionChains.size())) return nullptr;
+    return &sessionChains[slot];
+}
+
+std::vector<const Session*> Backend::getSessionsForPatient(int patientID) const {
+    TRACE_SPAN("backend", "getSessionsForPatient");
+    std::vector<const Session*> history;
+    const SessionChain* chain = chainFor(patientID);
+    if (!chain) return history;
+
+    history.reserve(chain->count);
+    for (const SessionNode* node = chain->first; node; node = node->nextOfPatient) {
+        history.push_back(&node->data);
+    }
+    return history;
+}
+
+const Session* Backend::getLastSession(int patientID) const {
+    const SessionChain* chain = chainFor(patientID);
+    return (chain && chain->last) ? &chain->last->data : nullptr;
+}
+
+int Backend::getSessionCount(int patientID) const {
+    const SessionChain* chain = chainFor(patientID);
+    return chain ? chain->count : 0;
+}
+
+std::vector<const Session*> Backend::searchNotes(const std::string& query, size_t limit) const {
+    TRACE_SPAN("backend", "searchNotes");
+    std::vector<const Session*> result;
+    for (const NotesIndex::Hit& hit : notesIndex.search(query, limit)) {
+        if (hit.doc < sessionArena.size()) result.push_back(&sessionArena[hit.doc].data);
+    }
+    return result;
 }
 
 // ===== Return a vector by traversing the LINKED LIST =====
+// The list threads through the arena nodes, so no node is allocated separately
 std::vector<Session> Backend::getAllSessionsLinkedList() const {
+    TRACE_SPAN("backend", "getAllSessionsLinkedList");
     std::vector<Session> result;
+    result.reserve(sessionArena.size());
     SessionNode* curr = sessionHead;
 
     while (curr != nullptr) {
@@ -129,16 +342,113 @@ std::vector<Session> Backend::getAllSessionsLinkedList() const {
 }
 
 
+// ================= ZERO-COPY VIEWS =================
+
+PatientRange Backend::patients() const {
+    return PatientRange(allPatients.begin(), allPatients.end(), allPatients.size());
+}
+
+PatientRange Backend::patientsPage(size_t offset, size_t count) const {
+    offset = std::min(offset, allPatients.size());
+    count = std::min(count, allPatients.size() - offset);
+    auto first = allPatients.begin() + offset;
+    return PatientRange(first, first + count, count);
+}
+
+SessionRange Backend::sessions() const {
+    using It = SessionLinkIterator<&SessionNode::next>;
+    return SessionRange(It(sessionHead), It(), sessionArena.size());
+}
+
+// The linked list runs in arena order, so a page can start at any arena slot
+SessionRange Backend::sessionsPage(size_t offset, size_t count) const {
+    using It = SessionLinkIterator<&SessionNode::next>;
+    offset = std::min(offset, sessionArena.size());
+    count = std::min(count, sessionArena.size() - offset);
+    if (count == 0) return SessionRange(It(), It(), 0);
+
+    const SessionNode* first = &sessionArena[offset];
+    const SessionNode* last = offset + count < sessionArena.size() ? &sessionArena[offset + count] : nullptr;
+    return SessionRange(It(first), It(last), count);
+}
+
+PatientSessionRange Backend::sessionsOf(int patientID) const {
+    using It = SessionLinkIterator<&SessionNode::nextOfPatient>;
+    const SessionChain* chain = chainFor(patientID);
+    if (!chain) return PatientSessionRange(It(), It(), 0);
+    return PatientSessionRange(It(chain->first), It(), chain->count);
+}
+
+
+// ================= DURABILITY =================
+
+// Records below the current ID counters are already loaded, which makes
+// replaying the same log (or a log overlapping a snapshot) harmless
+void Backend::restorePatient(const Patient& p) {
+    if (p.id < globalPatientID) return;
+    insertPatient(p);
+    globalPatientID = p.id + 1;
+}
+
+void Backend::restoreSession(const Session& s) {
+    if (s.session_id < globalSessionID) return;
+    insertSession(s);
+    globalSessionID = s.session_id + 1;
+}
+
+bool Backend::openJournal(const std::string& path, const JournalOptions& options) {
+    TRACE_SPAN("backend", "openJournal");
+    uint64_t validBytes = 0;
+    bool readable = Journal::replay(path,
+                                    [this](const Patient& p) { restorePatient(p); },
+                                    [this](const Session& s) { restoreSession(s); },
+                                    &validBytes);
+    if (!readable) return false;   // not ours: leave the file alone
+
+    journal.reset(new Journal());
+    if (!journal->open(path, validBytes, options)) {
+        journal.reset();
+        return false;
+    }
+    return true;
+}
+
+void Backend::closeJournal() {
+    journal.reset();   // flushes and fsyncs what is pending
+}
+
+
 // ================= RECENT VISITS =================
-void Backend::addRecentVisit(int patientID, const std::string& name) {
-    QueueNode node{patientID, name};
+void Backend::addRecentVisit(int patientID) {
+    TRACE_SPAN("backend", "addRecentVisit");
+    recentVisits.touch(patientID);
+    revisionCount++;
+    for (BackendObserver* o : observers) o->onRecentVisitsChanged(patientID);
+}
+
+std::vector<int> Backend::getRecentVisits() const {
+    std::vector<int> ids;
+    ids.reserve(recentVisits.size());
+    for (size_t i = 0; i < recentVisits.size(); ++i) {
+        ids.push_back(recentVisits.at(i));
+    }
+    return ids;
+}
+
+void Backend::setRecentVisitCapacity(size_t capacity) {
+    recentVisits.setCapacity(capacity);
+    revisionCount++;
+    for (BackendObserver* o : observers) o->onRecentVisitsChanged(-1);
+}
+
 
-    recentVisits.push_back(node);
-    if (recentVisits.size() > RECENT_VISIT_MAX) {
-        recentVisits.erase(recentVisits.begin());
+// ================= CHANGE NOTIFICATION =================
+void Backend::addObserver(BackendObserver* observer) {
+    if (std::find(observers.begin(), observers.end(), observer) == observers.end()) {
+        observers.push_back(observer);
     }
 }
 
-const std::vector<QueueNode>& Backend::getRecentVisits() const {
-    return recentVisits;
+void Backend::removeObserver(BackendObserver* observer) {
+    observers.erase(std::remove(observers.begin(), observers.end(), observer), observers.end());
 }
@@ -0,0 +1,339 @@
+#include "exporter.h"
+#include "backend.h"
+#include "trace.h"
+#include <algorithm>
+#include <charconv>
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#ifdef ESPRITCARE_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+namespace {
+
+// ---------- Double-buffered output ----------
+// The caller fills one buffer while the writer thread compresses and
+// writes the other. Memory is two buffers (plus the deflate state),
+// whatever the size of the export.
+class ExportSink
+{
+public:
+    ExportSink(std::FILE* file, size_t bufferSize, bool compress)
+        : file(file), capacity(std::max<size_t>(bufferSize, 4096)), compress(compress) {
+        filling.reserve(capacity);
+        writing.reserve(capacity);
+#ifdef ESPRITCARE_HAVE_ZLIB
+        if (compress) {
+            zstream = z_stream();
+            // windowBits 15 + 16 = gzip wrapper instead of raw zlib
+            good = deflateInit2(&zstream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) == Z_OK;
+            compressed.resize(capacity);
+        }
+#endif
+        writer = std::thread(&ExportSink::writerLoop, this);
+    }
+
+    ~ExportSink() {
+        if (writer.joinable()) finish();
+    }
+
+    void write(const char* data, size_t size) {
+        while (size > 0) {
+            size_t n = std::min(size, capacity - filling.size());
+            filling.append(data, n);
+            data += n;
+            size -= n;
+            if (filling.size() == capacity) handOff(false);
+        }
+    }
+
+    void write(const std::string& s) { write(s.data(), s.size()); }
+    void put(char c) {
+        filling.push_back(c);
+        if (filling.size() == capacity) handOff(false);
+    }
+
+    // Write the last buffer, end the gzip stream and stop the writer
+    bool finish() {
+        handOff(true);
+        writer.join();
+#ifdef ESPRITCARE_HAVE_ZLIB
+        if (compress) deflateEnd(&zstream);
+#endif
+        return good;
+    }
+
+    bool ok() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return good;
+    }
+
+    uint64_t bytesWritten() const { return written; }
+
+private:
+    // Wait for the writer to drain `writing`, then give it `filling`
+    void handOff(bool last) {
+        std::unique_lock<std::mutex> lock(mutex);
+        idle.wait(lock, [this] { return !busy; });
+        writing.swap(filling);
+        filling.clear();
+        busy = true;
+        finishing = last;
+        ready.notify_one();
+    }
+
+    void writerLoop() {
+        std::unique_lock<std::mutex> lock(mutex);
+        for (;;) {
+            ready.wait(lock, [this] { return busy; });
+            const bool last = finishing;
+            lock.unlock();
+
+            bool okay = emit(writing.data(), writing.size(), last);
+
+            lock.lock();
+            good = good && okay;
+            busy = false;
+            idle.notify_one();
+            if (last) return;
+        }
+    }
+
+    bool emit(const char* data, size_t size, bool last) {
+        if (!compress) return rawWrite(data, size);
+
+#ifdef ESPRITCARE_HAVE_ZLIB
+        zstream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+        zstream.avail_in = static_cast<uInt>(size);
+        int status;
+        do {
+            zstream.next_out = reinterpret_cast<Bytef*>(&compressed[0]);
+            zstream.avail_out = static_cast<uInt>(compressed.size());
+            status = deflate(&zstream, last ? Z_FINISH : Z_NO_FLUSH);
+            if (status == Z_STREAM_ERROR) return false;
+            if (!rawWrite(compressed.data(), compressed.size() - zstream.avail_out)) return false;
+        } while (zstream.avail_out == 0 || (last && status != Z_STREAM_END));
+        return true;
+#else
+        (void)last;
+        return false;
+#endif
+    }
+
+    bool rawWrite(const char* data, size_t size) {
+        if (size == 0) return true;
+        written += size;
+        return std::fwrite(data, 1, size, file) == size;
+    }
+
+    std::FILE* file;
+    const size_t capacity;
+    const bool compress;
+
+    std::string filling;        // caller side
+    std::string writing;        // writer side while busy
+    std::string compressed;
+    uint64_t written = 0;       // writer thread only, read after finish()
+#ifdef ESPRITCARE_HAVE_ZLIB
+    z_stream zstream;
+#endif
+
+    std::mutex mutex;           // guards busy, finishing, good
+    std::condition_variable ready;
+    std::condition_variable idle;
+    bool busy = false;
+    bool finishing = false;
+    bool good = true;
+    std::thread writer;
+};
+
+// ---------- Field formatting ----------
+void putInt(ExportSink& out, long long v) {
+    char digits[24];
+    auto r = std::to_chars(digits, digits + sizeof(digits), v);
+    out.write(digits, static_cast<size_t>(r.ptr - digits));
+}
+
+void putCsvField(ExportSink& out, const std::string& s) {
+    if (s.find_first_of(",\"\r\n") == std::string::npos) {
+        out.write(s);
+        return;
+    }
+    out.put('"');
+    for (char c : s) {
+        if (c == '"') out.put('"');
+        out.put(c);
+    }
+    out.put('"');
+}
+
+void putJsonString(ExportSink& out, const std::string& s) {
+    static const char hex[] = "0123456789abcdef";
+    out.put('"');
+    size_t plain = 0;   // start of the run of characters that need no escape
+    for (size_t i = 0; i < s.size(); ++i) {
+        unsigned char c = static_cast<unsigned char>(s[i]);
+        if (c >= 0x20 && c != '"' && c != '\\') continue;
+
+        out.write(s.data() + plain, i - plain);
+        plain = i + 1;
+        switch (c) {
+        case '"':  out.write("\\\"", 2); break;
+        case '\\': out.write("\\\\", 2); break;
+        case '\n': out.write("\\n", 2); break;
+        case '\r': out.write("\\r", 2); break;
+        case '\t': out.write("\\t", 2); break;
+        default: {
+            const char escape[6] = {'\\', 'u', '0', '0', hex[c >> 4], hex[c & 15]};
+            out.write(escape, 6);
+        }
+        }
+    }
+    out.write(s.data() + plain, s.size() - plain);
+    out.put('"');
+}
+
+// ---------- Record writers ----------
+void writeCsvPatient(ExportSink& out, const Backend& backend, const Patient& p, size_t& sessions) {
+    auto patientColumns = [&]() {
+        putInt(out, p.id);
+        out.put(',');
+        putCsvField(out, p.name);
+        out.put(',');
+        putCsvField(out, p.gender);
+        out.put(',');
+        putCsvField(out, p.birth_date);
+        out.put(',');
+        putInt(out, p.visit_count);
+        out.put(',');
+    };
+
+    PatientSessionRange history = backend.sessionsOf(p.id);
+    if (history.empty()) {
+        patientColumns();
+        out.write(",,,\n", 4);
+        return;
+    }
+    for (const Session& s : history) {
+        patientColumns();
+        putInt(out, s.session_id);
+        out.put(',');
+        putCsvField(out, s.date);
+        out.put(',');
+        putCsvField(out, s.notes);
+        out.put(',');
+        out.write(s.recording_hash);
+        out.put('\n');
+        sessions++;
+    }
+}
+
+void writeJsonPatient(ExportSink& out, const Backend& backend, const Patient& p, size_t& sessions) {
+    out.write("{\"id\":", 6);
+    putInt(out, p.id);
+    out.write(",\"name\":", 8);
+    putJsonString(out, p.name);
+    out.write(",\"gender\":", 10);
+    putJsonString(out, p.gender);
+    out.write(",\"birth_date\":", 14);
+    putJsonString(out, p.birth_date);
+    out.write(",\"visit_count\":", 15);
+    putInt(out, p.visit_count);
+    out.write(",\"sessions\":[", 13);
+
+    bool first = true;
+    for (const Session& s : backend.sessionsOf(p.id)) {
+        if (!first) out.put(',');
+        first = false;
+        out.write("{\"id\":", 6);
+        putInt(out, s.session_id);
+        out.write(",\"date\":", 8);
+        putJsonString(out, s.date);
+        out.write(",\"notes\":", 9);
+        putJsonString(out, s.notes);
+        out.write(",\"recording\":", 13);
+        putJsonString(out, s.recording_hash);
+        out.put('}');
+        sessions++;
+    }
+    out.write("]}\n", 3);
+}
+
+} // namespace
+
+bool exportCompressionAvailable() {
+#ifdef ESPRITCARE_HAVE_ZLIB
+    return true;
+#else
+    return false;
+#endif
+}
+
+ExportResult exportPatients(const Backend& backend, const std::string& path, const ExportOptions& options) {
+    TRACE_SPAN("backend", "exportPatients");
+    ExportResult result;
+    if (options.compress && !exportCompressionAvailable()) {
+        result.error = "this build has no compression support";
+        return result;
+    }
+
+    // Write next to the target and rename at the end, so a cancelled or
+    // failed export never leaves a truncated file under the real name
+    const std::string tempPath = path + ".part";
+    std::FILE* file = std::fopen(tempPath.c_str(), "wb");
+    if (!file) {
+        result.error = "cannot create " + path;
+        return result;
+    }
+
+    bool cancelled = false;
+    bool written = false;
+    {
+        ExportSink out(file, options.bufferSize, options.compress);
+        if (options.format == ExportFormat::Csv) {
+            out.write(std::string("patient_id,name,gender,birth_date,visit_count,session_id,date,notes,recording\n"));
+        }
+
+        const size_t total = backend.patientCount();
+        const size_t progressEvery = 4096;
+        for (const Patient& p : backend.patients()) {
+            if (options.format == ExportFormat::Csv) writeCsvPatient(out, backend, p, result.sessions);
+            else writeJsonPatient(out, backend, p, result.sessions);
+            result.patients++;
+
+            if (result.patients % progressEvery == 0) {
+                if (!out.ok()) break;
+                if (options.progress && !options.progress(result.patients, total)) {
+                    cancelled = true;
+                    break;
+                }
+            }
+        }
+
+        written = out.finish();
+        result.bytesWritten = out.bytesWritten();
+    }
+    written = std::fclose(file) == 0 && written;
+
+    if (cancelled || !written) {
+        std::remove(tempPath.c_str());
+        result.error = cancelled ? "export cancelled" : "write failed for " + path;
+        return result;
+    }
+    if (options.progress) options.progress(result.patients, backend.patientCount());
+
+#ifdef _WIN32
+    std::remove(path.c_str());
+#endif
+    if (std::rename(tempPath.c_str(), path.c_str()) != 0) {
+        std::remove(tempPath.c_str());
+        result.error = "cannot create " + path;
+        return result;
+    }
+    result.ok = true;
+    return result;
+}
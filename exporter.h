@@ -0,0 +1,55 @@
+#ifndef EXPORTER_H
+#define EXPORTER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+class Backend;
+
+// ================= STREAMING EXPORT =================
+// Writes every patient with their session history, straight from the
+// Backend's stores (patients() and sessionsOf()), so memory use does not
+// grow with the dataset: records are formatted into a fixed-size buffer
+// and a background thread writes out (and optionally gzips) the previous
+// buffer while the next one fills.
+//
+//   CSV         one row per session with its patient's columns repeated;
+//               patients without sessions get one row with empty session
+//               columns. Header:
+//               patient_id,name,gender,birth_date,visit_count,session_id,date,notes,recording
+//   JSON Lines  one object per patient with a "sessions" array
+//
+// Like the other views, the export must not overlap Backend mutations.
+
+enum class ExportFormat {
+    Csv,
+    JsonLines
+};
+
+struct ExportOptions {
+    ExportFormat format = ExportFormat::Csv;
+    bool compress = false;             // gzip; only in builds with zlib (ESPRITCARE_HAVE_ZLIB)
+    size_t bufferSize = 1 << 20;       // bytes per buffer; two are in use at a time
+
+    // Called every few thousand patients and once at the end with
+    // (patients written, total patients); return false to cancel
+    std::function<bool(size_t, size_t)> progress;
+};
+
+struct ExportResult {
+    bool ok = false;
+    std::string error;
+    size_t patients = 0;
+    size_t sessions = 0;
+    uint64_t bytesWritten = 0;         // after compression
+};
+
+ExportResult exportPatients(const Backend& backend, const std::string& path,
+                            const ExportOptions& options = ExportOptions());
+
+// True if this build can write gzip output
+bool exportCompressionAvailable();
+
+#endif // EXPORTER_H
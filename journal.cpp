@@ -0,0 +1,374 @@
+#include "journal.h"
+#include "backend.h"
+#include <chrono>
+#include <fstream>
+#include <iterator>
+#include <utility>
+
+#ifdef _WIN32
+#include <io.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+const char JOURNAL_MAGIC[8] = {'E', 'C', 'W', 'A', 'L', '0', '0', '1'};
+
+enum RecordType : uint8_t {
+    RECORD_PATIENT = 1,
+    RECORD_SESSION = 2
+};
+
+// ---------- CRC-32 (IEEE) ----------
+struct Crc32Table {
+    uint32_t entries[256];
+    Crc32Table() {
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; ++k) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            entries[i] = c;
+        }
+    }
+};
+
+uint32_t crc32(const char* data, size_t length) {
+    static const Crc32Table table;
+
+    uint32_t crc = 0xFFFFFFFFu;
+    for (size_t i = 0; i < length; ++i) {
+        crc = table.entries[(crc ^ static_cast<unsigned char>(data[i])) & 0xFF] ^ (crc >> 8);
+    }
+    return crc ^ 0xFFFFFFFFu;
+}
+
+// ---------- Encoding ----------
+void putU32(std::string& out, uint32_t v) {
+    char bytes[4] = {static_cast<char>(v), static_cast<char>(v >> 8),
+                     static_cast<char>(v >> 16), static_cast<char>(v >> 24)};
+    out.append(bytes, 4);
+}
+
+void putString(std::string& out, const std::string& s) {
+    putU32(out, static_cast<uint32_t>(s.size()));
+    out += s;
+}
+
+void encodePatient(std::string& payload, const Patient& patient) {
+    putU32(payload, static_cast<uint32_t>(patient.id));
+    putString(payload, patient.name);
+    putString(payload, patient.gender);
+    putString(payload, patient.birth_date);
+}
+
+// Bounds-checked reader over one record
+struct Reader {
+    const char* data;
+    size_t size;
+    size_t pos = 0;
+    bool ok = true;
+
+    uint32_t u32() {
+        if (size - pos < 4) { ok = false; return 0; }
+        const unsigned char* p = reinterpret_cast<const unsigned char*>(data + pos);
+        pos += 4;
+        return p[0] | (p[1] << 8) | (p[2] << 16) | (static_cast<uint32_t>(p[3]) << 24);
+    }
+
+    std::string str() {
+        uint32_t length = u32();
+        if (!ok || size - pos < length) { ok = false; return std::string(); }
+        std::string s(data + pos, length);
+        pos += length;
+        return s;
+    }
+};
+
+// ---------- Platform file calls ----------
+#ifdef _WIN32
+int openForAppend(const std::string& path) {
+    return _open(path.c_str(), _O_WRONLY | _O_CREAT | _O_BINARY, _S_IREAD | _S_IWRITE);
+}
+bool truncateTo(int fd, uint64_t size) { return _chsize_s(fd, static_cast<__int64>(size)) == 0; }
+bool seekEnd(int fd) { return _lseeki64(fd, 0, SEEK_END) >= 0; }
+long writeSome(int fd, const char* data, size_t size) {
+    return _write(fd, data, static_cast<unsigned>(size > 0x40000000 ? 0x40000000 : size));
+}
+bool syncFile(int fd) { return _commit(fd) == 0; }
+void closeFile(int fd) { _close(fd); }
+#else
+int openForAppend(const std::string& path) {
+    return ::open(path.c_str(), O_WRONLY | O_CREAT | O_CLOEXEC, 0644);
+}
+bool truncateTo(int fd, uint64_t size) { return ::ftruncate(fd, static_cast<off_t>(size)) == 0; }
+bool seekEnd(int fd) { return ::lseek(fd, 0, SEEK_END) >= 0; }
+long writeSome(int fd, const char* data, size_t size) { return ::write(fd, data, size); }
+bool syncFile(int fd) { return ::fsync(fd) == 0; }
+void closeFile(int fd) { ::close(fd); }
+#endif
+
+} // namespace
+
+Journal::~Journal() {
+    close();
+}
+
+// ================= REPLAY =================
+
+bool Journal::replay(const std::string& path,
+                     const std::function<void(const Patient&)>& onPatient,
+                     const std::function<void(const Session&)>& onSession,
+                     uint64_t* validBytes) {
+    if (validBytes) *validBytes = 0;
+
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return true;   // no journal yet
+
+    std::string data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    if (in.bad()) return false;
+    if (data.empty()) return true;
+
+    if (data.size() < sizeof(JOURNAL_MAGIC) ||
+        data.compare(0, sizeof(JOURNAL_MAGIC), JOURNAL_MAGIC, sizeof(JOURNAL_MAGIC)) != 0) {
+        return false;
+    }
+
+    size_t pos = sizeof(JOURNAL_MAGIC);
+    while (data.size() - pos >= 9) {
+        Reader header{data.data() + pos, 8};
+        uint32_t length = header.u32();
+        uint32_t crc = header.u32();
+
+        // Torn write or corruption: everything from here on is dropped
+        if (data.size() - pos - 8 < static_cast<size_t>(length) + 1) break;
+        const char* body = data.data() + pos + 8;
+        if (crc32(body, length + 1) != crc) break;
+
+        Reader r{body + 1, length};
+        uint8_t type = static_cast<uint8_t>(body[0]);
+        if (type == RECORD_PATIENT) {
+            Patient p;
+            p.id = static_cast<int>(r.u32());
+            p.name = r.str();
+            p.gender = r.str();
+            p.birth_date = r.str();
+            p.visit_count = 0;
+            if (!r.ok) break;
+            onPatient(p);
+        } else if (type == RECORD_SESSION) {
+            Session s;
+            s.session_id = static_cast<int>(r.u32());
+            s.patientID = static_cast<int>(r.u32());
+            s.date = r.str();
+            s.notes = r.str();
+            if (r.pos < r.size) s.recording_hash = r.str();
+            if (!r.ok) break;
+            onSession(s);
+        }
+        // Unknown types are skipped, so older builds can read newer logs
+
+        pos += 8 + length + 1;
+    }
+
+    if (validBytes) *validBytes = pos;
+    return true;
+}
+
+// ================= APPEND =================
+
+bool Journal::open(const std::string& path, uint64_t validBytes, const JournalOptions& opts) {
+    close();
+    options = opts;
+    error.clear();
+
+    fd = openForAppend(path);
+    if (fd < 0) {
+        error = "cannot open " + path;
+        return false;
+    }
+
+    // Fresh file: write the magic. Otherwise cut off any torn tail.
+    bool ok = true;
+    if (validBytes == 0) {
+        ok = truncateTo(fd, 0) && writeSome(fd, JOURNAL_MAGIC, sizeof(JOURNAL_MAGIC)) ==
+                                      static_cast<long>(sizeof(JOURNAL_MAGIC));
+    } else {
+        ok = truncateTo(fd, validBytes) && seekEnd(fd);
+    }
+    if (!ok || !syncFile(fd)) {
+        error = "cannot prepare " + path;
+        closeFile(fd);
+        fd = -1;
+        return false;
+    }
+
+    if (options.policy != SyncPolicy::EveryOperation) {
+        stopping = false;
+        flushRequested = false;
+        flusher = std::thread(&Journal::flusherLoop, this);
+    }
+    return true;
+}
+
+void Journal::close() {
+    if (flusher.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        flusher.join();
+    }
+
+    if (fd >= 0) {
+        sync();
+        closeFile(fd);
+        fd = -1;
+    }
+}
+
+void Journal::appendPatient(const Patient& patient) {
+    std::string payload;
+    encodePatient(payload, patient);
+    append(RECORD_PATIENT, payload);
+}
+
+void Journal::appendPatients(const std::vector<Patient>& patients) {
+    if (fd < 0 || patients.empty()) return;
+
+    std::string records, payload;
+    for (const Patient& patient : patients) {
+        payload.clear();
+        encodePatient(payload, patient);
+        encodeRecord(records, RECORD_PATIENT, payload);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        pending += records;
+        pendingRecords += patients.size();
+    }
+    sync();
+}
+
+void Journal::appendSession(const Session& session) {
+    std::string payload;
+    putU32(payload, static_cast<uint32_t>(session.session_id));
+    putU32(payload, static_cast<uint32_t>(session.patientID));
+    putString(payload, session.date);
+    putString(payload, session.notes);
+    putString(payload, session.recording_hash);
+    append(RECORD_SESSION, payload);
+}
+
+void Journal::encodeRecord(std::string& out, uint8_t type, const std::string& payload) {
+    std::string body(1, static_cast<char>(type));
+    body += payload;
+    putU32(out, static_cast<uint32_t>(payload.size()));
+    putU32(out, crc32(body.data(), body.size()));
+    out += body;
+}
+
+void Journal::append(uint8_t type, const std::string& payload) {
+    if (fd < 0) return;
+
+    std::string record;
+    encodeRecord(record, type, payload);
+
+    bool flushNow = false;
+    bool wakeFlusher = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        pending += record;
+        pendingRecords++;
+
+        switch (options.policy) {
+        case SyncPolicy::EveryOperation:
+            flushNow = true;
+            break;
+        case SyncPolicy::Batched:
+            if (pendingRecords >= options.batchSize && !flushRequested) {
+                flushRequested = true;
+                wakeFlusher = true;
+            }
+            break;
+        case SyncPolicy::Timed:
+            break;   // the flusher thread picks it up
+        }
+    }
+
+    if (flushNow) sync();
+    if (wakeFlusher) wake.notify_one();
+}
+
+// Group commit: take everything pending, then one write and one fsync.
+// Called from the flusher thread in the Batched and Timed modes, so
+// appends there only wait for the buffer swap, never for the disk.
+bool Journal::sync() {
+    std::lock_guard<std::mutex> writeLock(writeMutex);
+    if (fd < 0) return false;
+
+    std::string batch;
+    size_t batchRecords = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        batch.swap(pending);
+        std::swap(batchRecords, pendingRecords);
+    }
+    if (batch.empty()) return true;
+
+    size_t written = 0;
+    while (written < batch.size()) {
+        long n = writeSome(fd, batch.data() + written, batch.size() - written);
+        if (n <= 0) {
+            // Keep the unwritten records for the next attempt. Counting the
+            // whole batch back in lets the next append() trigger a retry.
+            std::lock_guard<std::mutex> lock(mutex);
+            error = "write failed";
+            pending.insert(0, batch, written, std::string::npos);
+            pendingRecords += batchRecords;
+            return false;
+        }
+        written += static_cast<size_t>(n);
+    }
+
+    if (!syncFile(fd)) {
+        std::lock_guard<std::mutex> lock(mutex);
+        error = "fsync failed";
+        return false;
+    }
+    return true;
+}
+
+bool Journal::reset() {
+    std::lock_guard<std::mutex> writeLock(writeMutex);
+    if (fd < 0) return false;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        pending.clear();
+        pendingRecords = 0;
+    }
+    return truncateTo(fd, sizeof(JOURNAL_MAGIC)) && seekEnd(fd) && syncFile(fd);
+}
+
+// Batched: wakes when append() fills a batch, and at the latest after one
+// interval so a partial batch is not left unsynced. Timed: every interval.
+void Journal::flusherLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!stopping) {
+        if (options.policy == SyncPolicy::Batched) {
+            wake.wait_for(lock, std::chrono::milliseconds(options.intervalMs),
+                          [this] { return stopping || flushRequested; });
+        } else {
+            wake.wait_for(lock, std::chrono::milliseconds(options.intervalMs), [this] { return stopping; });
+        }
+        flushRequested = false;
+        lock.unlock();
+        sync();
+        lock.lock();
+    }
+}
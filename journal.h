@@ -0,0 +1,98 @@
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct Patient;
+struct Session;
+
+// ================= WRITE-AHEAD LOG =================
+// Append-only binary log of every addPatient/addSession, replayed on
+// startup so the in-memory Backend survives a crash or restart.
+//
+// File layout: an 8-byte magic, then records of
+//     u32 payload length | u32 CRC-32 of (type + payload) | u8 type | payload
+// with little-endian integers and strings stored as u32 length + bytes.
+// Fields added later go at the end of a payload and are optional on
+// replay, so older records still read.
+// A torn or corrupt record ends the log; open() cuts it off before
+// appending so later records are never hidden behind it.
+
+// When appended records are forced to disk
+enum class SyncPolicy {
+    EveryOperation,   // write + fsync before append returns
+    Batched,          // group commit from a background thread every `batchSize` records,
+                      // or after `intervalMs` if a batch is still partial
+    Timed             // group commit from a background thread every `intervalMs`
+};
+
+struct JournalOptions {
+    SyncPolicy policy = SyncPolicy::Batched;
+    size_t batchSize = 32;
+    int intervalMs = 100;
+};
+
+class Journal
+{
+public:
+    Journal() = default;
+    ~Journal();
+
+    Journal(const Journal&) = delete;
+    Journal& operator=(const Journal&) = delete;
+
+    // Replay every intact record of `path` through the callbacks. Returns
+    // false only if the file exists but cannot be read or is not a journal;
+    // a missing file is an empty journal. `validBytes` receives the length
+    // of the intact prefix.
+    static bool replay(const std::string& path,
+                       const std::function<void(const Patient&)>& onPatient,
+                       const std::function<void(const Session&)>& onSession,
+                       uint64_t* validBytes = nullptr);
+
+    // Open for appending, dropping anything past `validBytes` (see replay())
+    bool open(const std::string& path, uint64_t validBytes, const JournalOptions& options = JournalOptions());
+    void close();
+    bool isOpen() const { return fd >= 0; }
+
+    void appendPatient(const Patient& patient);
+    void appendSession(const Session& session);
+
+    // Log a whole batch under one lock and force it to disk before returning
+    void appendPatients(const std::vector<Patient>& patients);
+
+    // Write and fsync everything appended so far
+    bool sync();
+
+    // Drop every record (after a checkpoint has captured them)
+    bool reset();
+
+    const std::string& lastError() const { return error; }
+
+private:
+    void append(uint8_t type, const std::string& payload);
+    static void encodeRecord(std::string& out, uint8_t type, const std::string& payload);
+    void flusherLoop();
+
+    int fd = -1;
+    JournalOptions options;
+    std::string error;
+
+    std::mutex mutex;           // guards pending, pendingRecords, error, flushRequested, stopping
+    std::string pending;        // encoded records not yet written
+    size_t pendingRecords = 0;
+    bool flushRequested = false;   // Batched: a full batch is waiting for the flusher
+    std::mutex writeMutex;      // one writer of the file at a time
+
+    std::thread flusher;
+    std::condition_variable wake;
+    bool stopping = false;
+};
+
+#endif // JOURNAL_H
@@ -1,16 +1,167 @@
-#include "mainwindow.h"
+#include "navigator.h"
 #include "espritdb.h"
+#include "backend.h"
+#include "bulkimport.h"
+#include "exporter.h"
+#include "theme.h"
+#include "trace.h"
+#include "stallwatchdog.h"
 #include <QApplication>
+#include <QStandardPaths>
+#include <QDir>
+#include <QFile>
+#include <QMessageBox>
+#include <QElapsedTimer>
+#include <cstdio>
+#include <cstring>
+
+static QString storagePath(const QString& fileName)
+{
+    QString dataDir = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+    QDir().mkpath(dataDir);
+    return QDir(dataDir).filePath(fileName);
+}
+
+// Saved data for the headless commands: snapshot, then the log after it
+static bool openStorage(Backend& backend)
+{
+    const QString snapshotFile = storagePath("espritcare.snap");
+    if (QFile::exists(snapshotFile) && !backend.loadSnapshot(QFile::encodeName(snapshotFile).toStdString())) {
+        std::fprintf(stderr, "Could not read the saved snapshot.\n");
+        return false;
+    }
+    if (!backend.openJournal(QFile::encodeName(storagePath("espritcare.wal")).toStdString())) {
+        std::fprintf(stderr, "Could not open the patient log.\n");
+        return false;
+    }
+    return true;
+}
+
+// Headless bulk import:  EspritCare --import patients.csv
+// Loads the saved data, adds every valid row of the file and writes a
+// fresh snapshot, without opening a window.
+static int runImport(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+    a.setApplicationName("EspritCare");
+    const QStringList args = a.arguments();
+
+    Backend backend;
+    if (!openStorage(backend)) return 1;
+
+    QElapsedTimer timer;
+    timer.start();
+    ImportResult result = importPatients(backend, QFile::encodeName(args.value(2)).toStdString());
+    if (!result.ok) {
+        std::fprintf(stderr, "Import failed: %s\n", result.error.c_str());
+        return 1;
+    }
+    const qint64 elapsed = timer.elapsed();
+
+    for (const ImportError& e : result.errors) {
+        std::fprintf(stderr, "line %zu: %s\n", e.line, e.message.c_str());
+    }
+    std::printf("Imported %zu patients (IDs %d-%d), rejected %zu rows, in %lld ms\n",
+                result.imported, result.firstID, result.firstID + static_cast<int>(result.imported) - 1,
+                result.rejected, static_cast<long long>(elapsed));
+
+    return backend.checkpoint(QFile::encodeName(storagePath("espritcare.snap")).toStdString()) ? 0 : 1;
+}
+
+// Headless export:  EspritCare --export audit.csv  (or .jsonl, plus .gz)
+// Streams every patient with their session history to the file.
+static int runExport(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+    a.setApplicationName("EspritCare");
+    QString target = a.arguments().value(2);
+
+    Backend backend;
+    if (!openStorage(backend)) return 1;
+
+    ExportOptions options;
+    QString base = target;
+    if (base.endsWith(".gz", Qt::CaseInsensitive)) {
+        options.compress = true;
+        base.chop(3);
+    }
+    if (base.endsWith(".jsonl", Qt::CaseInsensitive) || base.endsWith(".json", Qt::CaseInsensitive)) {
+        options.format = ExportFormat::JsonLines;
+    }
+    options.progress = [](size_t done, size_t total) {
+        std::fprintf(stderr, "\r%zu / %zu patients", done, total);
+        return true;
+    };
+
+    ExportResult result = exportPatients(backend, QFile::encodeName(target).toStdString(), options);
+    std::fprintf(stderr, "\n");
+    if (!result.ok) {
+        std::fprintf(stderr, "Export failed: %s\n", result.error.c_str());
+        return 1;
+    }
+    std::printf("Exported %zu patients and %zu sessions (%llu bytes)\n", result.patients, result.sessions,
+                static_cast<unsigned long long>(result.bytesWritten));
+    return 0;
+}
 
 int main(int argc, char *argv[])
 {
+    if (argc >= 3 && std::strcmp(argv[1], "--import") == 0) {
+        return runImport(argc, argv);
+    }
+    if (argc >= 3 && std::strcmp(argv[1], "--export") == 0) {
+        return runExport(argc, argv);
+    }
+
     QApplication a(argc, argv);
+    a.setApplicationName("EspritCare");
+    Theme::apply(a);
+
+    // Spans are recorded from the start, so a trace saved after a freeze
+    // (Ctrl+Shift+T) covers it. ESPRITCARE_TRACE=0 turns recording off.
+    tracing::setEnabled(qgetenv("ESPRITCARE_TRACE") != "0");
+    tracing::setThreadName("gui");
+
+    // Patients and sessions live in memory and are logged to disk as they
+    // are added, so the day's intake survives a crash or restart
+    Backend backend;
+    QString snapshotPath = storagePath("espritcare.snap");
+    QString journalPath = storagePath("espritcare.wal");
+
+    // Snapshot first (memory-mapped, indexes prebuilt), then whatever the
+    // log recorded after it
+    if (QFile::exists(snapshotPath) && !backend.loadSnapshot(QFile::encodeName(snapshotPath).toStdString())) {
+        QMessageBox::warning(nullptr, "Storage Error",
+                             "The saved patient snapshot could not be read:\n" + snapshotPath +
+                             "\n\nStarting from the patient log only.");
+    }
+    if (!backend.openJournal(QFile::encodeName(journalPath).toStdString())) {
+        QMessageBox::warning(nullptr, "Storage Error",
+                             "Could not open the patient log at:\n" + journalPath +
+                             "\n\nChanges made now will not be saved.");
+    }
+
+    // Warns when the event loop stops answering for ESPRITCARE_STALL_MS
+    // (default 50 ms), naming what the GUI thread was running. Declared
+    // first so it outlives the navigator, which shows its findings.
+    bool stallMsSet = false;
+    const int stallMs = qEnvironmentVariableIntValue("ESPRITCARE_STALL_MS", &stallMsSet);
+    StallWatchdog watchdog(stallMsSet && stallMs > 0 ? stallMs : 50);
+
+    // One window; screens are built once and switched in place
+    Navigator navigator(&backend);
+    navigator.setStallWatchdog(&watchdog);
+    navigator.show();
+
+    // Started last so loading the data above isn't counted as a stall
+    watchdog.start();
 
-    MainWindow w;
-    w.resize(800, 500);
-    w.show();
+    int result = a.exec();
+    watchdog.stop();   // nothing beats from here on
 
-    return a.exec();
+    // Fold the log into a fresh snapshot so the next start is quick
+    backend.checkpoint(QFile::encodeName(snapshotPath).toStdString());
+    return result;
 }
 
 
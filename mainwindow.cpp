@@ -1,11 +1,13 @@
 #include "mainwindow.h"
-#include "dashboardwindow.h"
+#include "navigator.h"
+#include "trace.h"
 #include <QLabel>
 #include <QPushButton>
 #include <QVBoxLayout>
 #include <QFont>
 
-MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent)
+MainWindow::MainWindow(Backend* backendPtr, Navigator* navigatorPtr, QWidget *parent)
+    : QMainWindow(parent), backend(backendPtr), navigator(navigatorPtr)
 {
     setupUi();
     resize(1000,600);
@@ -14,17 +16,13 @@ MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent)
 
 void MainWindow::setupUi()
 {
+    TRACE_SPAN("ui", "MainWindow::setupUi");
     // Central widget
     central = new QWidget(this);
     setCentralWidget(central);
 
-    // Perfectly smooth gradient background
-    central->setStyleSheet(R"(
-        QWidget {
-            background: qlineargradient(spread:pad, x1:0, y1:0, x2:1, y2:1,
-                        stop:0 #f3f7fc, stop:1 #d6e6f5);
-        }
-    )");
+    // Perfectly smooth gradient background (see theme.cpp)
+    central->setObjectName("screen");
 
     // Main layout
     QVBoxLayout *layout = new QVBoxLayout(central);
@@ -36,12 +34,7 @@ void MainWindow::setupUi()
     QFont titleFont("Segoe UI", 30, QFont::Bold);
     titleLabel->setFont(titleFont);
     titleLabel->setAlignment(Qt::AlignCenter);
-    titleLabel->setStyleSheet(R"(
-        QLabel {
-            color: #1f2f45;
-            background: transparent;
-        }
-    )");
+    titleLabel->setObjectName("appTitle");
 
     layout->addWidget(titleLabel);
 
@@ -51,12 +44,7 @@ void MainWindow::setupUi()
     taglineLabel->setFont(tagFont);
     taglineLabel->setAlignment(Qt::AlignCenter);
     taglineLabel->setWordWrap(true);
-    taglineLabel->setStyleSheet(R"(
-        QLabel {
-            color: #4a5e72;
-            background: transparent;
-        }
-    )");
+    taglineLabel->setObjectName("tagline");
 
     layout->addWidget(taglineLabel);
 
@@ -66,23 +54,7 @@ void MainWindow::setupUi()
     // Get Started button
     getStartedBtn = new QPushButton("Get Started", central);
     getStartedBtn->setFixedSize(200, 45);
-    getStartedBtn->setStyleSheet(R"(
-        QPushButton {
-            background-color: #2b7de9;
-            color: white;
-            font-size: 13pt;
-            font-weight: bold;
-            border-radius: 8px;
-            padding: 8px 16px;
-            border: none;
-        }
-        QPushButton:hover {
-            background-color: #358af0;
-        }
-        QPushButton:pressed {
-            background-color: #266bcc;
-        }
-    )");
+    getStartedBtn->setObjectName("getStartedButton");
 
     layout->addWidget(getStartedBtn, 0, Qt::AlignHCenter);
 
@@ -96,7 +68,5 @@ void MainWindow::setupUi()
 
 void MainWindow::onGetStartedClicked()
 {
-    DashboardWindow* dashboard=new DashboardWindow();
-    dashboard->show();
-    this->close();
+    navigator->go(Screen::Dashboard);
 }
@@ -1,6 +1,8 @@
 #pragma once
 #include <QMainWindow>
+#include "backend.h"
 
+class Navigator;
 class QLabel;
 class QPushButton;
 
@@ -8,7 +10,7 @@ class MainWindow : public QMainWindow
 {
     Q_OBJECT
 public:
-    explicit MainWindow(QWidget *parent = nullptr);
+    explicit MainWindow(Backend* backend, Navigator* navigator, QWidget *parent = nullptr);
 
 private slots:
     void onGetStartedClicked();
@@ -20,6 +22,8 @@ private:
     QLabel *titleLabel;
     QLabel *taglineLabel;
     QPushButton *getStartedBtn;
+    Backend* backend;
+    Navigator* navigator;
 };
 
 
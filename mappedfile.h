@@ -0,0 +1,38 @@
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <cstddef>
+#include <string>
+
+// ================= READ-ONLY MEMORY-MAPPED FILE =================
+// Maps a whole file for reading. Pages are faulted in by the OS on first
+// touch, so opening is O(1) regardless of file size. An empty file opens
+// with size() 0 and a null data().
+class MappedFile
+{
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool open(const std::string& path);
+    void close();
+
+    const char* data() const { return bytes; }
+    size_t size() const { return length; }
+
+    // Hint that the file will be read front to back (read-ahead)
+    void adviseSequential() const;
+
+private:
+    const char* bytes = nullptr;
+    size_t length = 0;
+#ifdef _WIN32
+    void* fileHandle = nullptr;
+    void* mappingHandle = nullptr;
+#endif
+};
+
+#endif // MAPPEDFILE_H
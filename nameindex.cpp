@@ -0,0 +1,242 @@
+#include "nameindex.h"
+#include "snapshotio.h"
+#include <algorithm>
+#include <thread>
+#include <tuple>
+
+std::string NameIndex::fold(const std::string& text) {
+    std::string folded = text;
+    for (char& c : folded) {
+        if (c >= 'A' && c <= 'Z') c = static_cast<char>(c - 'A' + 'a');
+    }
+    return folded;
+}
+
+uint32_t NameIndex::trigramKey(const char* p) {
+    return (static_cast<uint32_t>(static_cast<unsigned char>(p[0])) << 16) |
+           (static_cast<uint32_t>(static_cast<unsigned char>(p[1])) << 8) |
+           static_cast<uint32_t>(static_cast<unsigned char>(p[2]));
+}
+
+// Slots skipped over get an empty name
+void NameIndex::padTo(int slot) {
+    if (nameOffsets.empty()) nameOffsets.push_back(0);
+    while (static_cast<int>(size()) < slot) {
+        nameOffsets.push_back(static_cast<uint32_t>(nameData.size()));
+    }
+}
+
+// Each distinct trigram of the packed name at `slot`, once
+void NameIndex::trigramsOf(int slot, std::vector<uint32_t>& keys) const {
+    keys.clear();
+    const size_t start = nameOffsets[slot];
+    const size_t end = nameOffsets[slot + 1];
+    for (size_t i = start; i + 3 <= end; ++i) {
+        keys.push_back(trigramKey(nameData.data() + i));
+    }
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+}
+
+void NameIndex::add(int slot, const std::string& name) {
+    padTo(slot);
+    nameData += fold(name);
+    nameOffsets.push_back(static_cast<uint32_t>(nameData.size()));
+
+    std::vector<uint32_t> keys;
+    trigramsOf(slot, keys);
+    for (uint32_t key : keys) {
+        postings[key].push_back(slot);
+    }
+}
+
+void NameIndex::addBatch(int firstSlot, const std::vector<std::string_view>& names, unsigned threads) {
+    if (names.empty()) return;
+    padTo(firstSlot);
+
+    // === Pack the folded names (sequential, close to memcpy speed) ===
+    size_t total = 0;
+    for (std::string_view name : names) total += name.size();
+    nameData.reserve(nameData.size() + total);
+    nameOffsets.reserve(nameOffsets.size() + names.size());
+    for (std::string_view name : names) {
+        for (char c : name) {
+            nameData.push_back((c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c);
+        }
+        nameOffsets.push_back(static_cast<uint32_t>(nameData.size()));
+    }
+
+    // === Build posting lists per worker over contiguous slot runs ===
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    const size_t minPerWorker = 16384;
+    const size_t workers = std::min<size_t>(threads, (names.size() + minPerWorker - 1) / minPerWorker);
+
+    using Postings = std::unordered_map<uint32_t, std::vector<int>>;
+    std::vector<Postings> partial(workers);
+    auto build = [&](size_t w) {
+        const size_t begin = names.size() * w / workers;
+        const size_t end = names.size() * (w + 1) / workers;
+        std::vector<uint32_t> keys;
+        for (size_t i = begin; i < end; ++i) {
+            const int slot = firstSlot + static_cast<int>(i);
+            trigramsOf(slot, keys);
+            for (uint32_t key : keys) partial[w][key].push_back(slot);
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (size_t w = 1; w < workers; ++w) pool.emplace_back(build, w);
+    build(0);
+    for (std::thread& t : pool) t.join();
+
+    // === Append in slot order, so every list stays sorted ===
+    for (Postings& part : partial) {
+        for (auto& entry : part) {
+            std::vector<int>& list = postings[entry.first];
+            list.insert(list.end(), entry.second.begin(), entry.second.end());
+        }
+    }
+}
+
+// Intersect the posting lists of every trigram in the query, smallest first.
+// The result still has to be verified: sharing all trigrams does not
+// guarantee that they are adjacent in the right order.
+std::vector<int> NameIndex::candidatesFor(const std::string& folded) const {
+    std::vector<const std::vector<int>*> lists;
+    for (size_t i = 0; i + 3 <= folded.size(); ++i) {
+        auto it = postings.find(trigramKey(folded.data() + i));
+        if (it == postings.end()) return {};   // a trigram nobody has
+        lists.push_back(&it->second);
+    }
+
+    std::sort(lists.begin(), lists.end(), [](const std::vector<int>* a, const std::vector<int>* b) {
+        return a->size() < b->size();
+    });
+    lists.erase(std::unique(lists.begin(), lists.end()), lists.end());
+
+    std::vector<int> result = *lists.front();
+    for (size_t i = 1; i < lists.size() && !result.empty(); ++i) {
+        const std::vector<int>& other = *lists[i];
+        auto from = other.begin();
+        size_t kept = 0;
+        for (int slot : result) {
+            // Gallop forward, then binary search inside the bracket
+            size_t step = 1;
+            auto hi = from;
+            while (hi != other.end() && *hi < slot) {
+                from = hi;
+                hi = (static_cast<size_t>(other.end() - hi) > step) ? hi + step : other.end();
+                step *= 2;
+            }
+            from = std::lower_bound(from, hi, slot);
+            if (from == other.end()) break;
+            if (*from == slot) result[kept++] = slot;
+        }
+        result.resize(kept);
+    }
+    return result;
+}
+
+size_t NameIndex::matchPosition(int slot, const std::string& folded) const {
+    const char* begin = nameData.data() + nameOffsets[slot];
+    const char* end = nameData.data() + nameOffsets[slot + 1];
+    const char* hit = std::search(begin, end, folded.begin(), folded.end());
+    return hit == end ? std::string::npos : static_cast<size_t>(hit - begin);
+}
+
+std::vector<int> NameIndex::search(const std::string& query, size_t limit,
+                                   const std::atomic<bool>* cancelled) const {
+    std::string folded = fold(query);
+    if (folded.empty() || size() == 0) return {};
+
+    // (rank class, match position, name length, slot)
+    using Ranked = std::tuple<int, size_t, size_t, int>;
+    std::vector<Ranked> matches;
+
+    auto consider = [&](int slot) {
+        size_t pos = matchPosition(slot, folded);
+        if (pos == std::string::npos) return;
+
+        int rankClass = 2;
+        if (pos == 0) rankClass = 0;
+        else if (nameData[nameOffsets[slot] + pos - 1] == ' ') rankClass = 1;
+        matches.emplace_back(rankClass, pos, nameOffsets[slot + 1] - nameOffsets[slot], slot);
+    };
+
+    // Poll the cancel flag every few thousand names, not on every one
+    auto isCancelled = [&](size_t i) {
+        return cancelled && (i & 4095) == 0 && cancelled->load(std::memory_order_relaxed);
+    };
+
+    if (folded.size() < 3) {
+        // Too short to have a trigram: scan the packed names instead
+        for (int slot = 0; slot < static_cast<int>(size()); ++slot) {
+            if (isCancelled(slot)) return {};
+            consider(slot);
+        }
+    } else {
+        std::vector<int> candidates = candidatesFor(folded);
+        for (size_t i = 0; i < candidates.size(); ++i) {
+            if (isCancelled(i)) return {};
+            consider(candidates[i]);
+        }
+    }
+    if (cancelled && cancelled->load(std::memory_order_relaxed)) return {};
+
+    if (limit > 0 && matches.size() > limit) {
+        std::partial_sort(matches.begin(), matches.begin() + limit, matches.end());
+        matches.resize(limit);
+    } else {
+        std::sort(matches.begin(), matches.end());
+    }
+
+    std::vector<int> slots;
+    slots.reserve(matches.size());
+    for (const Ranked& m : matches) slots.push_back(std::get<3>(m));
+    return slots;
+}
+
+// ================= SNAPSHOT =================
+
+void NameIndex::save(SnapshotWriter& out) const {
+    out.array(nameData);
+    out.array(nameOffsets);
+
+    out.value<uint64_t>(postings.size());
+    for (const auto& entry : postings) {
+        out.value<uint64_t>(entry.first);
+        out.array(entry.second);
+    }
+}
+
+bool NameIndex::load(SnapshotReader& in, size_t slotCount) {
+    if (!in.array(nameData) || !in.array(nameOffsets)) return false;
+
+    // Offsets must walk nameData from start to end, one name per slot
+    if (size() != slotCount) return false;
+    for (size_t i = 0; i < nameOffsets.size(); ++i) {
+        if (nameOffsets[i] > nameData.size() || (i > 0 && nameOffsets[i] < nameOffsets[i - 1])) return false;
+    }
+    if (!nameOffsets.empty() && (nameOffsets.front() != 0 || nameOffsets.back() != nameData.size())) return false;
+
+    uint64_t keyCount = 0;
+    if (!in.value(keyCount)) return false;
+
+    postings.clear();
+    postings.reserve(static_cast<size_t>(keyCount));
+    for (uint64_t i = 0; i < keyCount; ++i) {
+        uint64_t key = 0;
+        if (!in.value(key)) return false;
+
+        size_t count = 0;
+        const int* slots = in.view<int>(count);
+        if (!in.ok()) return false;
+        for (size_t k = 0; k < count; ++k) {
+            if (slots[k] < 0 || static_cast<size_t>(slots[k]) >= slotCount || (k > 0 && slots[k] <= slots[k - 1])) {
+                return false;
+            }
+        }
+        postings[static_cast<uint32_t>(key)].assign(slots, slots + count);
+    }
+    return true;
+}
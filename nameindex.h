@@ -0,0 +1,67 @@
+#ifndef NAMEINDEX_H
+#define NAMEINDEX_H
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+class SnapshotWriter;
+class SnapshotReader;
+
+// ================= TRIGRAM NAME INDEX =================
+// Inverted index from case-folded trigrams to patient slots, used for
+// substring search over patient names. Slots are appended in increasing
+// order, so every posting list stays sorted without extra work.
+class NameIndex
+{
+public:
+    // Index the name stored at `slot` (slots must be added in increasing order)
+    void add(int slot, const std::string& name);
+
+    // Index names[i] at slot firstSlot + i. Posting lists are built across
+    // `threads` workers (0 = one per core), each over a contiguous run of
+    // slots, then appended in slot order so they stay sorted.
+    void addBatch(int firstSlot, const std::vector<std::string_view>& names, unsigned threads = 0);
+
+    // Slots whose name contains `query` (case-insensitive), best match first.
+    // Ranking: match at start of name, then at start of a word, then anywhere;
+    // ties go to the earlier match, the shorter name, then the lower slot.
+    // A `limit` of 0 returns every match. If `cancelled` is set while the
+    // search runs, it stops early and returns an empty list.
+    std::vector<int> search(const std::string& query, size_t limit = 0,
+                            const std::atomic<bool>* cancelled = nullptr) const;
+
+    size_t size() const { return nameOffsets.empty() ? 0 : nameOffsets.size() - 1; }
+
+    static std::string fold(const std::string& text);
+
+    // The folded name stored at `slot` (a view into the index)
+    std::string_view folded(int slot) const {
+        return std::string_view(nameData.data() + nameOffsets[slot], nameOffsets[slot + 1] - nameOffsets[slot]);
+    }
+
+    // Prebuilt index in/out of a snapshot, so startup does not re-tokenize;
+    // load() checks names and posting lists cover exactly `slotCount` slots
+    void save(SnapshotWriter& out) const;
+    bool load(SnapshotReader& in, size_t slotCount);
+
+private:
+    static uint32_t trigramKey(const char* p);
+
+    void padTo(int slot);
+    void trigramsOf(int slot, std::vector<uint32_t>& keys) const;   // distinct, sorted
+
+    std::vector<int> candidatesFor(const std::string& folded) const;
+    size_t matchPosition(int slot, const std::string& folded) const;
+
+    // Folded names packed back to back; name of slot i is
+    // [nameOffsets[i], nameOffsets[i + 1]) in nameData.
+    std::string nameData;
+    std::vector<uint32_t> nameOffsets;
+    std::unordered_map<uint32_t, std::vector<int>> postings;   // trigram -> sorted slots
+};
+
+#endif // NAMEINDEX_H
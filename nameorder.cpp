@@ -0,0 +1,198 @@
+#include "nameorder.h"
+#include "nameindex.h"
+#include "snapshotio.h"
+#include <algorithm>
+
+// Fixed pseudo-random priority per slot (splitmix32 finalizer)
+uint32_t NameOrder::priority(int slot) {
+    uint32_t x = static_cast<uint32_t>(slot) + 0x9E3779B9u;
+    x = (x ^ (x >> 16)) * 0x85EBCA6Bu;
+    x = (x ^ (x >> 13)) * 0xC2B2AE35u;
+    return x ^ (x >> 16);
+}
+
+// Zero-padded, so comparing prefixes agrees with comparing the names
+uint64_t NameOrder::prefixOf(int slot, const NameIndex& names) {
+    std::string_view name = names.folded(slot);
+    uint64_t prefix = 0;
+    for (size_t i = 0; i < 8; ++i) {
+        prefix = (prefix << 8) | (i < name.size() ? static_cast<unsigned char>(name[i]) : 0);
+    }
+    return prefix;
+}
+
+bool NameOrder::less(int a, int b, const NameIndex& names) const {
+    if (nodes[a].prefix != nodes[b].prefix) return nodes[a].prefix < nodes[b].prefix;
+    int c = names.folded(a).compare(names.folded(b));
+    return c < 0 || (c == 0 && a < b);
+}
+
+void NameOrder::grow(int slot, const NameIndex& names) {
+    if (slot >= static_cast<int>(nodes.size())) nodes.resize(slot + 1);
+    nodes[slot] = Node();
+    nodes[slot].prefix = prefixOf(slot, names);
+}
+
+// ================= INSERT =================
+
+void NameOrder::add(int slot, const NameIndex& names) {
+    grow(slot, names);
+    root = insert(root, slot, names);
+}
+
+// Walk down by name until the new slot outranks a node, then split that
+// subtree around it. Expected depth is O(log n).
+int NameOrder::insert(int node, int slot, const NameIndex& names) {
+    if (node < 0) return slot;
+
+    if (priority(slot) > priority(node)) {
+        split(node, slot, names, nodes[slot].left, nodes[slot].right);
+        update(slot);
+        return slot;
+    }
+
+    if (less(slot, node, names)) nodes[node].left = insert(nodes[node].left, slot, names);
+    else nodes[node].right = insert(nodes[node].right, slot, names);
+    update(node);
+    return node;
+}
+
+// Nodes before `slot` go to `lower`, the rest to `upper`
+void NameOrder::split(int node, int slot, const NameIndex& names, int& lower, int& upper) {
+    if (node < 0) {
+        lower = upper = -1;
+        return;
+    }
+    if (less(node, slot, names)) {
+        split(nodes[node].right, slot, names, nodes[node].right, upper);
+        lower = node;
+    } else {
+        split(nodes[node].left, slot, names, lower, nodes[node].left);
+        upper = node;
+    }
+    update(node);
+}
+
+void NameOrder::addBatch(int firstSlot, size_t count, const NameIndex& names) {
+    if (count == 0) return;
+
+    // A handful of rows into a big tree: plain inserts are cheaper than a merge
+    if (count * 16 < size()) {
+        for (size_t i = 0; i < count; ++i) add(firstSlot + static_cast<int>(i), names);
+        return;
+    }
+
+    std::vector<int> batch(count);
+    for (size_t i = 0; i < count; ++i) {
+        batch[i] = firstSlot + static_cast<int>(i);
+        grow(batch[i], names);
+    }
+    std::sort(batch.begin(), batch.end(), [&](int a, int b) { return less(a, b, names); });
+
+    std::vector<int> current = inOrder();
+    std::vector<int> merged(current.size() + batch.size());
+    std::merge(current.begin(), current.end(), batch.begin(), batch.end(), merged.begin(),
+               [&](int a, int b) { return less(a, b, names); });
+
+    build(merged);
+}
+
+// ================= LOOKUP =================
+
+int NameOrder::slotAt(size_t row) const {
+    int node = root;
+    while (node >= 0) {
+        size_t before = sizeOf(nodes[node].left);
+        if (row < before) {
+            node = nodes[node].left;
+        } else if (row == before) {
+            return node;
+        } else {
+            row -= before + 1;
+            node = nodes[node].right;
+        }
+    }
+    return -1;
+}
+
+size_t NameOrder::rowOf(int slot, const NameIndex& names) const {
+    size_t row = 0;
+    int node = root;
+    while (node >= 0) {
+        if (node == slot) return row + sizeOf(nodes[node].left);
+        if (less(slot, node, names)) {
+            node = nodes[node].left;
+        } else {
+            row += sizeOf(nodes[node].left) + 1;
+            node = nodes[node].right;
+        }
+    }
+    return size();   // not in the tree
+}
+
+// ================= BULK BUILD =================
+
+std::vector<int> NameOrder::inOrder() const {
+    std::vector<int> sorted, stack;
+    sorted.reserve(size());
+    int node = root;
+    while (node >= 0 || !stack.empty()) {
+        while (node >= 0) {
+            stack.push_back(node);
+            node = nodes[node].left;
+        }
+        node = stack.back();
+        stack.pop_back();
+        sorted.push_back(node);
+        node = nodes[node].right;
+    }
+    return sorted;
+}
+
+// Cartesian tree of an already sorted sequence in one pass: the stack holds
+// the right spine, and a node's subtree is final once it leaves the stack
+void NameOrder::build(const std::vector<int>& sorted) {
+    std::vector<int> spine;
+    for (int slot : sorted) {
+        int last = -1;
+        while (!spine.empty() && priority(spine.back()) < priority(slot)) {
+            last = spine.back();
+            spine.pop_back();
+            update(last);
+        }
+        nodes[slot].left = last;
+        nodes[slot].right = -1;
+        if (!spine.empty()) nodes[spine.back()].right = slot;
+        spine.push_back(slot);
+    }
+    root = spine.empty() ? -1 : spine.front();
+    while (!spine.empty()) {
+        update(spine.back());
+        spine.pop_back();
+    }
+}
+
+// ================= SNAPSHOT =================
+
+void NameOrder::save(SnapshotWriter& out) const {
+    out.array(inOrder());
+}
+
+bool NameOrder::load(SnapshotReader& in, const NameIndex& names) {
+    std::vector<int> sorted;
+    if (!in.array(sorted) || sorted.size() != names.size()) return false;
+
+    for (size_t slot = 0; slot < sorted.size(); ++slot) grow(static_cast<int>(slot), names);
+
+    // Must be every slot exactly once, in name order
+    std::vector<bool> seen(sorted.size(), false);
+    for (size_t i = 0; i < sorted.size(); ++i) {
+        int slot = sorted[i];
+        if (slot < 0 || static_cast<size_t>(slot) >= sorted.size() || seen[slot]) return false;
+        if (i > 0 && !less(sorted[i - 1], slot, names)) return false;
+        seen[slot] = true;
+    }
+
+    build(sorted);
+    return true;
+}
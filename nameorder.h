@@ -0,0 +1,66 @@
+#ifndef NAMEORDER_H
+#define NAMEORDER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class NameIndex;
+class SnapshotWriter;
+class SnapshotReader;
+
+// ================= NAME ORDER (A-Z) =================
+// Patient slots sorted by case-folded name (ties: lower slot first), kept
+// as an order-statistic treap. Every node knows the size of its subtree,
+// so the slot at a row, the row of a slot and inserting a new patient are
+// all O(log n); nothing is ever re-sorted.
+//
+// Nodes are indexed by slot in one flat array. A node's priority is a
+// hash of its slot, so it takes no space and the tree can be rebuilt in
+// O(n) from the sorted order alone (which is all a snapshot stores).
+// Names are read from the NameIndex, which already holds them folded;
+// each node keeps the first 8 bytes as an integer, so most comparisons
+// on the way down never touch the name itself.
+class NameOrder
+{
+public:
+    void add(int slot, const NameIndex& names);   // slots must be added in increasing order
+
+    // Slots firstSlot .. firstSlot + count - 1 at once: large batches are
+    // sorted on their own and merged into the tree in one O(n) pass
+    void addBatch(int firstSlot, size_t count, const NameIndex& names);
+
+    size_t size() const { return nodes.size(); }
+    int slotAt(size_t row) const;                          // row 0 = first name A-Z
+    size_t rowOf(int slot, const NameIndex& names) const;
+
+    // Sorted slots in/out of a snapshot; load() checks the order against `names`
+    void save(SnapshotWriter& out) const;
+    bool load(SnapshotReader& in, const NameIndex& names);
+
+private:
+    static uint32_t priority(int slot);
+    static uint64_t prefixOf(int slot, const NameIndex& names);
+    bool less(int a, int b, const NameIndex& names) const;
+
+    struct Node {
+        int left = -1;
+        int right = -1;
+        uint32_t size = 1;   // nodes in this subtree
+        uint64_t prefix = 0; // first 8 bytes of the folded name, big-endian
+    };
+
+    uint32_t sizeOf(int node) const { return node < 0 ? 0 : nodes[node].size; }
+    void update(int node) { nodes[node].size = 1 + sizeOf(nodes[node].left) + sizeOf(nodes[node].right); }
+    void grow(int slot, const NameIndex& names);
+
+    int insert(int node, int slot, const NameIndex& names);
+    void split(int node, int slot, const NameIndex& names, int& lower, int& upper);
+    void build(const std::vector<int>& sorted);
+    std::vector<int> inOrder() const;
+
+    std::vector<Node> nodes;   // by slot; one cache miss per step down the tree
+    int root = -1;
+};
+
+#endif // NAMEORDER_H
@@ -0,0 +1,134 @@
+#include "navigator.h"
+#include "mainwindow.h"
+#include "dashboardwindow.h"
+#include "addpatientwindow.h"
+#include "addsessionwindow.h"
+#include "viewpatientwindow.h"
+#include "backendsignals.h"
+#include "diagnosticsdialog.h"
+#include "trace.h"
+#include <QStackedWidget>
+#include <QTimer>
+#include <QShortcut>
+#include <QStandardPaths>
+#include <QDir>
+#include <QFile>
+#include <QDateTime>
+#include <QMessageBox>
+
+Navigator::Navigator(Backend* backendPtr, QWidget* parent)
+    : QMainWindow(parent), backend(backendPtr)
+{
+    backendChanges = new BackendSignals(backend, this);
+
+    stack = new QStackedWidget(this);
+    setCentralWidget(stack);
+
+    // Support can ask for the last few seconds of backend and screen
+    // activity after a freeze
+    QShortcut* traceShortcut = new QShortcut(QKeySequence("Ctrl+Shift+T"), this);
+    connect(traceShortcut, &QShortcut::activated, this, &Navigator::saveTrace);
+    QShortcut* diagnosticsShortcut = new QShortcut(QKeySequence("Ctrl+Shift+D"), this);
+    connect(diagnosticsShortcut, &QShortcut::activated, this, &Navigator::showDiagnostics);
+
+    resize(1000, 600);
+    setMinimumSize(800, 500);
+    go(Screen::Welcome);
+}
+
+void Navigator::saveTrace()
+{
+    QString dataDir = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+    QDir().mkpath(dataDir);
+    QString path = QDir(dataDir).filePath(
+        QString("trace-%1.json").arg(QDateTime::currentDateTime().toString("yyyyMMdd-hhmmss")));
+
+    if (!tracing::writeChromeTrace(QFile::encodeName(path).toStdString())) {
+        QMessageBox::warning(this, "Trace", "Could not write the trace to:\n" + path);
+        return;
+    }
+    QMessageBox::information(this, "Trace Saved",
+                             "Recent activity was saved to:\n" + path +
+                             "\n\nOpen it in chrome://tracing or ui.perfetto.dev.");
+}
+
+// Not modal, so it can stay open next to the screen being investigated
+void Navigator::showDiagnostics()
+{
+    if (!diagnostics) diagnostics = new DiagnosticsDialog(this, watchdog, this);
+    diagnostics->show();
+    diagnostics->raise();
+    diagnostics->activateWindow();
+}
+
+QMainWindow* Navigator::page(Screen screen)
+{
+    switch (screen) {
+    case Screen::Welcome:
+        if (!welcome) welcome = new MainWindow(backend, this);
+        return welcome;
+    case Screen::Dashboard:
+        if (!dashboard) dashboard = new DashboardWindow(backend, this);
+        return dashboard;
+    case Screen::AddPatient:
+        if (!addPatient) addPatient = new AddPatientWindow(backend, this);
+        return addPatient;
+    case Screen::AddSession:
+        if (!addSession) addSession = new AddSessionWindow(backend, this);
+        return addSession;
+    case Screen::ViewPatients:
+        if (!viewPatients) viewPatients = new ViewPatientWindow(backend, this);
+        return viewPatients;
+    }
+    return nullptr;
+}
+
+void Navigator::prepare(Screen screen)
+{
+    switch (screen) {
+    case Screen::Welcome:
+    case Screen::Dashboard:   // kept current by backendChanges
+        break;
+    case Screen::AddPatient:
+        addPatient->resetForm();
+        break;
+    case Screen::AddSession:
+        addSession->resetForm();
+        break;
+    case Screen::ViewPatients:
+        viewPatients->resetForm();
+        break;
+    }
+}
+
+void Navigator::go(Screen screen)
+{
+    TRACE_SPAN("ui", "Navigator::go");
+    switchClock.start();
+
+    // Screens are ordinary QMainWindows; as pages they must lose their own
+    // top-level frame, or each would still open as a separate window
+    QMainWindow* target = page(screen);
+    const bool built = stack->indexOf(target) < 0;
+    if (built) {
+        target->setWindowFlags(Qt::Widget);
+        stack->addWidget(target);
+    } else {
+        prepare(screen);
+    }
+
+    stack->setCurrentWidget(target);
+    setWindowTitle(target->windowTitle());
+    currentScreen = screen;
+
+    // Posted behind the paint of the new page, so this measures until the
+    // switch is actually visible
+    QTimer::singleShot(0, this, [this, screen, built]() { recordSwitch(screen, built); });
+}
+
+void Navigator::recordSwitch(Screen screen, bool built)
+{
+    ScreenSwitch entry{screen, built, switchClock.nsecsElapsed() / 1e6};
+    if (switches.size() == SWITCH_HISTORY) switches.removeFirst();
+    switches.append(entry);
+}
@@ -0,0 +1,75 @@
+#pragma once
+#include <QMainWindow>
+#include <QElapsedTimer>
+#include <QVector>
+#include "backend.h"
+
+class QStackedWidget;
+class BackendSignals;
+class MainWindow;
+class DashboardWindow;
+class AddPatientWindow;
+class AddSessionWindow;
+class ViewPatientWindow;
+class StallWatchdog;
+class DiagnosticsDialog;
+
+enum class Screen { Welcome, Dashboard, AddPatient, AddSession, ViewPatients };
+
+// One screen switch: how long until the target was on screen
+struct ScreenSwitch {
+    Screen screen;
+    bool built;      // first visit: the screen had to be constructed
+    double ms;
+};
+
+// ================= NAVIGATOR =================
+// The application's only top-level window. Each screen is built the first
+// time it is needed and then kept alive in a QStackedWidget, so switching
+// back to it is a page flip: forms are reset, instead of running setupUi()
+// again. Screens showing backend data keep it current through changes().
+class Navigator : public QMainWindow
+{
+    Q_OBJECT
+public:
+    explicit Navigator(Backend* backend, QWidget* parent = nullptr);
+
+    void go(Screen screen);
+    Screen current() const { return currentScreen; }
+
+    // Backend change signals, shared by every screen
+    BackendSignals* changes() const { return backendChanges; }
+
+    // Most recent switches, oldest first (at most SWITCH_HISTORY)
+    const QVector<ScreenSwitch>& switchHistory() const { return switches; }
+
+    static const int SWITCH_HISTORY = 64;
+
+    // Shown in the diagnostics panel (Ctrl+Shift+D); must outlive the navigator
+    void setStallWatchdog(StallWatchdog* stallWatchdog) { watchdog = stallWatchdog; }
+
+    void saveTrace();   // Ctrl+Shift+T, see trace.h
+
+private:
+    void showDiagnostics();
+    QMainWindow* page(Screen screen);   // builds the screen on first use
+    void prepare(Screen screen);        // reset / reload before showing it
+    void recordSwitch(Screen screen, bool built);
+
+    Backend* backend;
+    BackendSignals* backendChanges;
+    QStackedWidget* stack;
+    Screen currentScreen = Screen::Welcome;
+
+    MainWindow* welcome = nullptr;
+    DashboardWindow* dashboard = nullptr;
+    AddPatientWindow* addPatient = nullptr;
+    AddSessionWindow* addSession = nullptr;
+    ViewPatientWindow* viewPatients = nullptr;
+
+    QElapsedTimer switchClock;
+    QVector<ScreenSwitch> switches;
+
+    StallWatchdog* watchdog = nullptr;
+    DiagnosticsDialog* diagnostics = nullptr;   // built on first use
+};
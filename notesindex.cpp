@@ -0,0 +1,450 @@
+#include "notesindex.h"
+#include "snapshotio.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+const double BM25_K1 = 1.2;
+const double BM25_B = 0.75;
+const size_t MAX_PREFIX_TERMS = 64;   // a prefix expands to at most this many (most frequent) terms
+const uint32_t NO_DOC = std::numeric_limits<uint32_t>::max();
+
+void putVarint(std::string& out, uint32_t v) {
+    while (v >= 0x80) {
+        out.push_back(static_cast<char>(v | 0x80));
+        v >>= 7;
+    }
+    out.push_back(static_cast<char>(v));
+}
+
+// Bounds-checked, since streams may come from a snapshot file
+uint32_t getVarint(const std::string& in, size_t& pos) {
+    uint32_t v = 0;
+    for (int shift = 0; pos < in.size() && shift < 35; shift += 7) {
+        unsigned char b = static_cast<unsigned char>(in[pos++]);
+        v |= static_cast<uint32_t>(b & 0x7F) << shift;
+        if (!(b & 0x80)) break;
+    }
+    return v;
+}
+
+bool isWordByte(unsigned char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c >= 0x80;
+}
+
+} // namespace
+
+// ================= POSTING CURSOR =================
+// Walks one term's postings in doc order. Positions are only decoded for
+// cursors that ask for them (phrase queries).
+class NotesIndex::Cursor
+{
+public:
+    Cursor(const Term& term, bool withPositions, double idf)
+        : idf(idf), term(&term), withPositions(withPositions) {}
+
+    const double idf;   // computed once per query, not per scored document
+
+    bool atEnd() const { return ended; }
+    uint32_t doc() const { return currentDoc; }
+    uint32_t tf() const { return currentTf; }
+    uint32_t docFreq() const { return term->docFreq; }
+
+    bool next() {
+        if (index >= term->docFreq) {
+            ended = true;
+            return false;
+        }
+        if (withPositions && started) {
+            for (uint32_t i = 0; i < currentTf; ++i) getVarint(term->positions, positionsPos);
+        }
+        currentDoc += getVarint(term->docs, docsPos);
+        currentTf = getVarint(term->docs, docsPos);
+        index++;
+        started = true;
+        return true;
+    }
+
+    // Move to the first posting with doc >= target
+    bool advanceTo(uint32_t target) {
+        if (ended) return false;
+        if (started && currentDoc >= target) return true;
+
+        // Jump to the last block starting before `target`, if it is ahead
+        const std::vector<Skip>& skips = term->skips;
+        auto after = std::partition_point(skips.begin(), skips.end(),
+                                          [target](const Skip& s) { return s.lastDoc < target; });
+        if (after != skips.begin()) {
+            const size_t block = static_cast<size_t>(after - skips.begin()) - 1;
+            const uint32_t blockStart = static_cast<uint32_t>(block * SKIP_INTERVAL);
+            if (blockStart > index) {
+                currentDoc = skips[block].lastDoc;
+                docsPos = skips[block].docsOffset;
+                positionsPos = skips[block].positionsOffset;
+                index = blockStart;
+                started = false;
+            }
+        }
+
+        while (next()) {
+            if (currentDoc >= target) return true;
+        }
+        return false;
+    }
+
+    // Positions of the current posting, ascending
+    void positions(std::vector<uint32_t>& out) const {
+        out.clear();
+        size_t pos = positionsPos;
+        uint32_t position = 0;
+        for (uint32_t i = 0; i < currentTf; ++i) {
+            position += getVarint(term->positions, pos);
+            out.push_back(position);
+        }
+    }
+
+private:
+    const Term* term;
+    bool withPositions;
+    size_t docsPos = 0;
+    size_t positionsPos = 0;   // start of the current posting's positions
+    uint32_t index = 0;        // postings read so far
+    uint32_t currentDoc = 0;
+    uint32_t currentTf = 0;
+    bool started = false;
+    bool ended = false;
+};
+
+// One part of a query; every clause has to match a document
+struct NotesIndex::Clause {
+    enum Kind { TERM, PREFIX, PHRASE } kind;
+    std::vector<Cursor> cursors;
+    uint32_t phraseTf = 0;     // PHRASE: occurrences in the current doc
+
+    uint64_t cost() const {
+        uint64_t total = 0;
+        for (const Cursor& c : cursors) {
+            total = kind == PHRASE ? std::min<uint64_t>(total ? total : c.docFreq(), c.docFreq())
+                                   : total + c.docFreq();
+        }
+        return total;
+    }
+};
+
+// ================= INDEXING =================
+
+void NotesIndex::tokenize(const std::string& text, std::string& folded, std::vector<std::string_view>& tokens) {
+    folded = text;
+    for (char& c : folded) {
+        if (c >= 'A' && c <= 'Z') c = static_cast<char>(c - 'A' + 'a');
+    }
+
+    tokens.clear();
+    size_t i = 0;
+    while (i < folded.size()) {
+        while (i < folded.size() && !isWordByte(static_cast<unsigned char>(folded[i]))) ++i;
+        size_t start = i;
+        while (i < folded.size() && isWordByte(static_cast<unsigned char>(folded[i]))) ++i;
+        if (i == start) break;
+        tokens.emplace_back(folded.data() + start, i - start);
+    }
+}
+
+void NotesIndex::add(uint32_t doc, const std::string& text) {
+    if (doc < docLengths.size()) return;   // already indexed
+    docLengths.resize(doc, 0);             // docs skipped over are empty
+
+    std::string folded;
+    std::vector<std::string_view> tokens;
+    tokenize(text, folded, tokens);
+    docLengths.push_back(static_cast<uint32_t>(tokens.size()));
+    totalLength += tokens.size();
+
+    // (term, position) pairs, grouped by term with positions ascending
+    std::vector<std::pair<uint32_t, uint32_t>> occurrences;
+    occurrences.reserve(tokens.size());
+    for (size_t i = 0; i < tokens.size(); ++i) {
+        auto it = termIds.find(tokens[i]);
+        if (it == termIds.end()) {
+            const uint32_t id = static_cast<uint32_t>(terms.size());
+            auto entry = vocabulary.emplace(std::string(tokens[i]), id).first;
+            it = termIds.emplace(entry->first, id).first;
+            terms.emplace_back();
+        }
+        occurrences.emplace_back(it->second, static_cast<uint32_t>(i));
+    }
+    std::sort(occurrences.begin(), occurrences.end());
+
+    for (size_t i = 0; i < occurrences.size();) {
+        size_t end = i;
+        while (end < occurrences.size() && occurrences[end].first == occurrences[i].first) ++end;
+
+        Term& term = terms[occurrences[i].first];
+        if (term.docFreq % SKIP_INTERVAL == 0) {
+            term.skips.push_back({term.lastDoc, static_cast<uint32_t>(term.docs.size()),
+                                  static_cast<uint32_t>(term.positions.size())});
+        }
+        putVarint(term.docs, doc - term.lastDoc);
+        putVarint(term.docs, static_cast<uint32_t>(end - i));
+
+        uint32_t previous = 0;
+        for (size_t k = i; k < end; ++k) {
+            putVarint(term.positions, occurrences[k].second - previous);
+            previous = occurrences[k].second;
+        }
+
+        term.lastDoc = doc;
+        term.docFreq++;
+        i = end;
+    }
+}
+
+size_t NotesIndex::postingBytes() const {
+    size_t total = 0;
+    for (const Term& term : terms) {
+        total += term.docs.size() + term.positions.size() + term.skips.size() * sizeof(Skip);
+    }
+    return total;
+}
+
+const NotesIndex::Term* NotesIndex::find(std::string_view token) const {
+    auto it = termIds.find(token);
+    return it == termIds.end() ? nullptr : &terms[it->second];
+}
+
+// ================= RANKING =================
+
+double NotesIndex::idf(uint32_t docFreq) const {
+    const double n = static_cast<double>(docLengths.size());
+    return std::log(1.0 + (n - docFreq + 0.5) / (docFreq + 0.5));
+}
+
+double NotesIndex::tfNorm(uint32_t tf, uint32_t docLength) const {
+    const double averageLength = docLengths.empty() ? 1.0 : double(totalLength) / docLengths.size();
+    return tf * (BM25_K1 + 1.0) / (tf + BM25_K1 * (1.0 - BM25_B + BM25_B * docLength / averageLength));
+}
+
+// BM25 share of one clause at `doc`; a phrase scores like its words would,
+// counting only the places where they appear together
+double NotesIndex::score(const Clause& clause, uint32_t doc) const {
+    const uint32_t docLength = doc < docLengths.size() ? docLengths[doc] : 0;
+    double total = 0.0;
+    switch (clause.kind) {
+    case Clause::TERM:
+        total = clause.cursors[0].idf * tfNorm(clause.cursors[0].tf(), docLength);
+        break;
+    case Clause::PREFIX:
+        for (const Cursor& c : clause.cursors) {
+            if (!c.atEnd() && c.doc() == doc) total += c.idf * tfNorm(c.tf(), docLength);
+        }
+        break;
+    case Clause::PHRASE:
+        for (const Cursor& c : clause.cursors) total += c.idf;
+        total *= tfNorm(clause.phraseTf, docLength);
+        break;
+    }
+    return total;
+}
+
+// ================= MATCHING =================
+
+// First doc >= target that `clause` matches, or NO_DOC. Targets only grow.
+uint32_t NotesIndex::advance(Clause& clause, uint32_t target) const {
+    switch (clause.kind) {
+    case Clause::TERM:
+        return clause.cursors[0].advanceTo(target) ? clause.cursors[0].doc() : NO_DOC;
+
+    case Clause::PREFIX: {
+        uint32_t best = NO_DOC;
+        for (Cursor& c : clause.cursors) {
+            if (c.advanceTo(target)) best = std::min(best, c.doc());
+        }
+        return best;
+    }
+
+    case Clause::PHRASE: {
+        std::vector<uint32_t> first, other;
+        for (;;) {
+            // Bring every word to the same doc
+            uint32_t doc = target;
+            for (size_t i = 0; i < clause.cursors.size();) {
+                if (!clause.cursors[i].advanceTo(doc)) return NO_DOC;
+                if (clause.cursors[i].doc() > doc) {
+                    doc = clause.cursors[i].doc();
+                    i = 0;
+                } else {
+                    ++i;
+                }
+            }
+
+            // Count the places where word i sits i positions after word 0
+            clause.cursors[0].positions(first);
+            uint32_t count = 0;
+            for (uint32_t start : first) {
+                bool together = true;
+                for (size_t i = 1; i < clause.cursors.size() && together; ++i) {
+                    clause.cursors[i].positions(other);
+                    together = std::binary_search(other.begin(), other.end(), start + static_cast<uint32_t>(i));
+                }
+                if (together) count++;
+            }
+            if (count > 0) {
+                clause.phraseTf = count;
+                return doc;
+            }
+            target = doc + 1;
+        }
+    }
+    }
+    return NO_DOC;
+}
+
+std::vector<NotesIndex::Hit> NotesIndex::search(const std::string& query, size_t limit) const {
+    // === Parse into clauses ===
+    std::vector<Clause> clauses;
+    std::string folded;
+    std::vector<std::string_view> tokens;
+
+    auto addWords = [&](const std::string& text, bool prefix) {
+        tokenize(text, folded, tokens);
+        if (tokens.empty()) return true;   // nothing searchable in this part
+
+        if (prefix && tokens.size() == 1) {
+            const std::string stem(tokens[0]);
+            std::vector<const Term*> expansions;
+            for (auto it = vocabulary.lower_bound(stem);
+                 it != vocabulary.end() && it->first.compare(0, stem.size(), stem) == 0; ++it) {
+                expansions.push_back(&terms[it->second]);
+            }
+            if (expansions.empty()) return false;
+            if (expansions.size() > MAX_PREFIX_TERMS) {
+                std::nth_element(expansions.begin(), expansions.begin() + MAX_PREFIX_TERMS, expansions.end(),
+                                 [](const Term* a, const Term* b) { return a->docFreq > b->docFreq; });
+                expansions.resize(MAX_PREFIX_TERMS);
+            }
+            Clause clause{Clause::PREFIX, {}};
+            for (const Term* t : expansions) clause.cursors.emplace_back(*t, false, idf(t->docFreq));
+            clauses.push_back(std::move(clause));
+            return true;
+        }
+
+        // One word, or several that must appear together ("chest pain", covid-19)
+        Clause clause{tokens.size() == 1 ? Clause::TERM : Clause::PHRASE, {}};
+        for (std::string_view token : tokens) {
+            const Term* term = find(token);
+            if (!term) return false;   // a word nobody wrote: no document can match
+            clause.cursors.emplace_back(*term, clause.kind == Clause::PHRASE, idf(term->docFreq));
+        }
+        clauses.push_back(std::move(clause));
+        return true;
+    };
+
+    for (size_t i = 0; i < query.size();) {
+        if (query[i] == '"') {
+            size_t close = query.find('"', i + 1);
+            if (close == std::string::npos) close = query.size();
+            if (!addWords(query.substr(i + 1, close - i - 1), false)) return {};
+            i = close + 1;
+        } else if (query[i] == ' ' || query[i] == '\t') {
+            ++i;
+        } else {
+            size_t end = query.find_first_of(" \t\"", i);
+            if (end == std::string::npos) end = query.size();
+            std::string word = query.substr(i, end - i);
+            bool prefix = word.size() > 1 && word.back() == '*';
+            if (!addWords(word, prefix)) return {};
+            i = end;
+        }
+    }
+    if (clauses.empty()) return {};
+
+    // The rarest clause drives; the others only confirm its candidates
+    std::sort(clauses.begin(), clauses.end(),
+              [](const Clause& a, const Clause& b) { return a.cost() < b.cost(); });
+
+    // === Leapfrog every clause onto the same doc, keep the best `limit` ===
+    auto better = [](const Hit& a, const Hit& b) {
+        return a.score > b.score || (a.score == b.score && a.doc > b.doc);   // ties: newer first
+    };
+    std::vector<Hit> hits;   // heap whose top is the worst kept hit
+
+    uint32_t candidate = advance(clauses[0], 0);
+    while (candidate != NO_DOC) {
+        bool agreed = true;
+        for (size_t c = 1; c < clauses.size(); ++c) {
+            uint32_t doc = advance(clauses[c], candidate);
+            if (doc != candidate) {
+                candidate = doc == NO_DOC ? NO_DOC : advance(clauses[0], doc);
+                agreed = false;
+                break;
+            }
+        }
+        if (!agreed) continue;
+
+        Hit hit{candidate, 0.0};
+        for (const Clause& clause : clauses) hit.score += score(clause, candidate);
+
+        if (limit == 0 || hits.size() < limit) {
+            hits.push_back(hit);
+            std::push_heap(hits.begin(), hits.end(), better);
+        } else if (better(hit, hits.front())) {
+            std::pop_heap(hits.begin(), hits.end(), better);
+            hits.back() = hit;
+            std::push_heap(hits.begin(), hits.end(), better);
+        }
+
+        candidate = advance(clauses[0], candidate + 1);
+    }
+
+    std::sort_heap(hits.begin(), hits.end(), better);
+    return hits;
+}
+
+// ================= SNAPSHOT =================
+
+void NotesIndex::save(SnapshotWriter& out) const {
+    out.array(docLengths);
+    out.value(totalLength);
+
+    // Terms in vocabulary order, so load() can rebuild the map with hints
+    out.value<uint64_t>(vocabulary.size());
+    for (const auto& entry : vocabulary) {
+        const Term& term = terms[entry.second];
+        out.array(entry.first);
+        out.value(term.docFreq);
+        out.value(term.lastDoc);
+        out.array(term.docs);
+        out.array(term.positions);
+        out.array(term.skips);
+    }
+}
+
+bool NotesIndex::load(SnapshotReader& in) {
+    termIds.clear();
+    vocabulary.clear();
+    terms.clear();
+    if (!in.array(docLengths) || !in.value(totalLength)) return false;
+
+    uint64_t termTotal = 0;
+    if (!in.value(termTotal)) return false;
+    terms.reserve(static_cast<size_t>(termTotal));
+    termIds.reserve(static_cast<size_t>(termTotal));
+    for (uint64_t i = 0; i < termTotal; ++i) {
+        std::string text;
+        Term term;
+        if (!in.array(text) || !in.value(term.docFreq) || !in.value(term.lastDoc) ||
+            !in.array(term.docs) || !in.array(term.positions) || !in.array(term.skips)) {
+            return false;
+        }
+        if (term.skips.size() != (term.docFreq + SKIP_INTERVAL - 1) / SKIP_INTERVAL) return false;
+        for (const Skip& s : term.skips) {
+            if (s.docsOffset > term.docs.size() || s.positionsOffset > term.positions.size()) return false;
+        }
+        auto entry = vocabulary.emplace_hint(vocabulary.end(), std::move(text), static_cast<uint32_t>(terms.size()));
+        termIds.emplace(entry->first, entry->second);
+        terms.push_back(std::move(term));
+    }
+    return vocabulary.size() == terms.size() && termIds.size() == terms.size();
+}
@@ -0,0 +1,99 @@
+#ifndef NOTESINDEX_H
+#define NOTESINDEX_H
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+class SnapshotWriter;
+class SnapshotReader;
+
+// ================= SESSION NOTES INDEX =================
+// Full-text inverted index over session notes, keyed by document number
+// (Backend uses the session's position in its arena). Documents are added
+// in increasing order, one per addSession(), so posting lists only ever
+// grow at the end.
+//
+// Tokens are runs of letters and digits, case-folded (ASCII); bytes of
+// multi-byte UTF-8 characters count as letters.
+//
+// Each term's postings are varint-compressed in two streams:
+//   docs       doc delta, term frequency            (per posting)
+//   positions  position deltas within the document  (tf per posting)
+// so plain term queries never decode positions. A skip entry every
+// SKIP_INTERVAL postings lets AND queries jump over long lists.
+//
+// Query syntax (all parts must match; results ranked by BM25):
+//   fever cough        both words
+//   "chest pain"       the words next to each other, in order
+//   amox*              any word starting with "amox"
+class NotesIndex
+{
+public:
+    struct Hit {
+        uint32_t doc;
+        double score;
+    };
+
+    NotesIndex() = default;
+    NotesIndex(const NotesIndex&) = delete;              // termIds points into vocabulary
+    NotesIndex& operator=(const NotesIndex&) = delete;
+    NotesIndex(NotesIndex&&) = default;                  // map nodes move with the map
+    NotesIndex& operator=(NotesIndex&&) = default;
+
+    // Index `text` as document `doc` (docs must be added in increasing order)
+    void add(uint32_t doc, const std::string& text);
+
+    // Best `limit` matches, highest score first (0 = all matches)
+    std::vector<Hit> search(const std::string& query, size_t limit = 20) const;
+
+    size_t documentCount() const { return docLengths.size(); }
+    size_t termCount() const { return terms.size(); }
+    size_t postingBytes() const;   // compressed size of every posting list
+
+    // Prebuilt index in/out of a snapshot
+    void save(SnapshotWriter& out) const;
+    bool load(SnapshotReader& in);
+
+    static const uint32_t SKIP_INTERVAL = 128;
+
+private:
+    struct Skip {
+        uint32_t lastDoc;            // doc of the posting just before this block
+        uint32_t docsOffset;         // where the block starts in `docs`
+        uint32_t positionsOffset;    // where the block starts in `positions`
+    };
+
+    struct Term {
+        std::string docs;
+        std::string positions;
+        std::vector<Skip> skips;     // skips[k] = state before posting k * SKIP_INTERVAL
+        uint32_t docFreq = 0;
+        uint32_t lastDoc = 0;
+    };
+
+    class Cursor;
+    struct Clause;
+
+    // Case-fold `text` into `folded` and split it into views over `folded`
+    static void tokenize(const std::string& text, std::string& folded, std::vector<std::string_view>& tokens);
+    const Term* find(std::string_view token) const;
+    uint32_t advance(Clause& clause, uint32_t target) const;
+    double score(const Clause& clause, uint32_t doc) const;
+    double idf(uint32_t docFreq) const;
+    double tfNorm(uint32_t tf, uint32_t docLength) const;
+
+    // term -> index in terms. vocabulary owns the strings and keeps them
+    // ordered for prefix queries; termIds hashes views of the same strings
+    // (map keys never move) for the per-token lookups.
+    std::map<std::string, uint32_t> vocabulary;
+    std::unordered_map<std::string_view, uint32_t> termIds;
+    std::vector<Term> terms;
+    std::vector<uint32_t> docLengths;             // tokens per document
+    uint64_t totalLength = 0;
+};
+
+#endif // NOTESINDEX_H
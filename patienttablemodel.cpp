@@ -0,0 +1,193 @@
+#include "patienttablemodel.h"
+#include "trace.h"
+#include <algorithm>
+#include <climits>
+
+PatientTableModel::PatientTableModel(Backend* backendPtr, QObject* parent)
+    : QAbstractTableModel(parent), backend(backendPtr), today(QDate::currentDate())
+{
+}
+
+int PatientTableModel::rowCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : loadedRows;
+}
+
+int PatientTableModel::columnCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : ColumnCount;
+}
+
+// Rows the current listing has in total; views are limited to int rows
+int PatientTableModel::availableRows() const
+{
+    size_t total = filtered ? matches.size() : backend->patientCount();
+    return static_cast<int>(std::min<size_t>(total, INT_MAX));
+}
+
+bool PatientTableModel::canFetchMore(const QModelIndex& parent) const
+{
+    return !parent.isValid() && loadedRows < availableRows();
+}
+
+void PatientTableModel::fetchMore(const QModelIndex& parent)
+{
+    TRACE_SPAN("ui", "PatientTableModel::fetchMore");
+    if (parent.isValid()) return;
+
+    int batch = std::min(FETCH_BATCH, availableRows() - loadedRows);
+    if (batch <= 0) return;
+
+    beginInsertRows(QModelIndex(), loadedRows, loadedRows + batch - 1);
+    loadedRows += batch;
+    endInsertRows();
+}
+
+const Patient* PatientTableModel::patientAt(int row) const
+{
+    if (row < 0 || row >= loadedRows) return nullptr;
+    if (filtered) return matches[row];
+    return &backend->patientAt(static_cast<size_t>(row), currentOrder);
+}
+
+// One new patient is inserted at its row if that row is already loaded;
+// below that, fetchMore() will reach it. A bulk import scatters its rows,
+// so the loaded rows are just repainted. Search results stay as searched.
+void PatientTableModel::onPatientsAdded(int firstID, int count)
+{
+    TRACE_SPAN("ui", "PatientTableModel::onPatientsAdded");
+    if (filtered || loadedRows == 0) return;
+
+    if (count == 1) {
+        size_t row = backend->rowOf(firstID, currentOrder);
+        if (row < static_cast<size_t>(loadedRows)) {
+            beginInsertRows(QModelIndex(), static_cast<int>(row), static_cast<int>(row));
+            loadedRows++;
+            endInsertRows();
+        }
+        return;
+    }
+    emit dataChanged(index(0, 0), index(loadedRows - 1, ColumnCount - 1));
+}
+
+// A session changes the patient's last visit. In last-visit order it also
+// moves the patient to the top, shifting the rows above its old place.
+void PatientTableModel::onSessionAdded(int sessionID, int patientID)
+{
+    TRACE_SPAN("ui", "PatientTableModel::onSessionAdded");
+    Q_UNUSED(sessionID);
+    if (loadedRows == 0) return;
+
+    int row = loadedRows;
+    if (filtered) {
+        for (int i = 0; i < loadedRows; ++i) {
+            if (matches[i]->id == patientID) {
+                row = i;
+                break;
+            }
+        }
+    } else if (currentOrder == PatientOrder::RecentVisit) {
+        emit dataChanged(index(0, 0), index(loadedRows - 1, ColumnCount - 1));
+        return;
+    } else {
+        row = static_cast<int>(std::min<size_t>(backend->rowOf(patientID, currentOrder), loadedRows));
+    }
+
+    if (row < loadedRows) emit dataChanged(index(row, LastVisitColumn), index(row, LastVisitColumn));
+}
+
+// Formatted per call; the view only asks for the rows it paints
+QVariant PatientTableModel::data(const QModelIndex& index, int role) const
+{
+    const Patient* p = index.isValid() ? patientAt(index.row()) : nullptr;
+    if (!p) return QVariant();
+
+    if (role == Qt::UserRole) return p->id;
+    if (role == Qt::TextAlignmentRole) {
+        return index.column() == NameColumn ? int(Qt::AlignLeft | Qt::AlignVCenter) : int(Qt::AlignCenter);
+    }
+    if (role != Qt::DisplayRole) return QVariant();
+
+    switch (index.column()) {
+    case IdColumn:
+        return p->id;
+    case NameColumn:
+        return QString::fromStdString(p->name);
+    case AgeColumn: {
+        QDate birth = QDate::fromString(QString::fromStdString(p->birth_date), Qt::ISODate);
+        if (!birth.isValid()) return QString("-");
+        int age = today.year() - birth.year();
+        if (today.month() < birth.month() || (today.month() == birth.month() && today.day() < birth.day())) {
+            age--;
+        }
+        return age;
+    }
+    case LastVisitColumn: {
+        const Session* last = backend->getLastSession(p->id);
+        return last ? QString::fromStdString(last->date) : QString("Never");
+    }
+    }
+    return QVariant();
+}
+
+QVariant PatientTableModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (orientation != Qt::Horizontal || role != Qt::DisplayRole) {
+        return QAbstractTableModel::headerData(section, orientation, role);
+    }
+
+    switch (section) {
+    case IdColumn:        return QString("Patient ID");
+    case NameColumn:      return QString("Name");
+    case AgeColumn:       return QString("Age");
+    case LastVisitColumn: return QString("Last Visit");
+    }
+    return QVariant();
+}
+
+// Both listings start empty; the view pulls the first batch itself
+void PatientTableModel::showAll()
+{
+    TRACE_SPAN("ui", "PatientTableModel::showAll");
+    beginResetModel();
+    filtered = false;
+    matches.clear();
+    loadedRows = 0;
+    today = QDate::currentDate();
+    endResetModel();
+}
+
+void PatientTableModel::showMatches(std::vector<Patient*> found)
+{
+    TRACE_SPAN("ui", "PatientTableModel::showMatches");
+    beginResetModel();
+    filtered = true;
+    matches = std::move(found);
+    sortMatches();
+    loadedRows = 0;
+    today = QDate::currentDate();
+    endResetModel();
+}
+
+// Only the rows on screen are re-read; the backend keeps every order ready
+void PatientTableModel::setOrder(PatientOrder order)
+{
+    TRACE_SPAN("ui", "PatientTableModel::setOrder");
+    if (order == currentOrder) return;
+
+    beginResetModel();
+    currentOrder = order;
+    if (filtered) sortMatches();
+    loadedRows = 0;
+    endResetModel();
+}
+
+// Matches take their row in the chosen order, one O(log n) lookup each
+void PatientTableModel::sortMatches()
+{
+    std::vector<std::pair<size_t, Patient*>> keyed;
+    keyed.reserve(matches.size());
+    for (Patient* p : matches) keyed.emplace_back(backend->rowOf(p->id, currentOrder), p);
+    std::sort(keyed.begin(), keyed.end());
+    for (size_t i = 0; i < keyed.size(); ++i) matches[i] = keyed[i].second;
+}
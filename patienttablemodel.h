@@ -0,0 +1,59 @@
+#pragma once
+#include <QAbstractTableModel>
+#include <QDate>
+#include <vector>
+#include "backend.h"
+
+// ================= PATIENT TABLE MODEL =================
+// Read-only table over Backend's patient storage. Nothing is copied:
+// rows are handed to the view a batch at a time through fetchMore(), and
+// each cell is formatted in data() only when the view paints it, so the
+// table opens in the same time for 100 or 10M patients.
+//
+// Shows either every patient or the matches of the last search, in one of
+// the Backend's maintained orders: switching order or reading any row is
+// O(log n), never a sort of the whole registry. Patient pointers stay
+// valid for the Backend's lifetime, so matches can be held between paints.
+//
+// Connected to BackendSignals, new patients and sessions show up in the
+// rows already loaded without a reset.
+class PatientTableModel : public QAbstractTableModel
+{
+    Q_OBJECT
+public:
+    enum Column { IdColumn, NameColumn, AgeColumn, LastVisitColumn, ColumnCount };
+
+    explicit PatientTableModel(Backend* backend, QObject* parent = nullptr);
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+    bool canFetchMore(const QModelIndex& parent) const override;
+    void fetchMore(const QModelIndex& parent) override;
+
+    void showAll();                                   // every patient
+    void showMatches(std::vector<Patient*> matches);  // search results
+    void setOrder(PatientOrder order);
+    PatientOrder order() const { return currentOrder; }
+
+    const Patient* patientAt(int row) const;
+
+    // Backend changes (see BackendSignals)
+    void onPatientsAdded(int firstID, int count);
+    void onSessionAdded(int sessionID, int patientID);
+
+    static const int FETCH_BATCH = 256;   // rows handed to the view per fetchMore()
+
+private:
+    int availableRows() const;
+    void sortMatches();
+
+    Backend* backend;
+    PatientOrder currentOrder = PatientOrder::Name;
+    bool filtered = false;
+    std::vector<Patient*> matches;
+    int loadedRows = 0;   // rows the view knows about so far
+    QDate today;          // for the age column, taken when the rows are (re)loaded
+};
@@ -0,0 +1,84 @@
+#include "recencyorder.h"
+
+// ================= FENWICK MARKS =================
+
+// The new node covers (i - lowbit(i), i]; everything but element i itself
+// is already counted by the prefix sums
+void RecencyOrder::Marks::append(bool mark) {
+    const size_t i = tree.size() + 1;
+    const size_t covered = i - (i & (~i + 1));
+    tree.push_back(static_cast<uint32_t>((mark ? 1 : 0) + prefix(i - 1) - prefix(covered)));
+    if (mark) marked++;
+}
+
+void RecencyOrder::Marks::add(size_t i, int delta) {
+    for (size_t node = i + 1; node <= tree.size(); node += node & (~node + 1)) {
+        tree[node - 1] += delta;
+    }
+    marked += delta;
+}
+
+size_t RecencyOrder::Marks::prefix(size_t count) const {
+    size_t sum = 0;
+    for (size_t node = count; node > 0; node -= node & (~node + 1)) {
+        sum += tree[node - 1];
+    }
+    return sum;
+}
+
+// Binary descent: take every power-of-two block that stays under k + 1 marks
+size_t RecencyOrder::Marks::select(size_t k) const {
+    size_t step = 1;
+    while (step * 2 <= tree.size()) step *= 2;
+
+    size_t position = 0, remaining = k + 1;
+    for (; step > 0; step /= 2) {
+        if (position + step <= tree.size() && tree[position + step - 1] < remaining) {
+            position += step;
+            remaining -= tree[position - 1];
+        }
+    }
+    return position;
+}
+
+// ================= ORDER =================
+
+void RecencyOrder::addPatient(int slot) {
+    while (unvisited.size() < static_cast<size_t>(slot)) {
+        unvisited.append(false);   // gap in the slots: nobody to list
+        latest.push_back(-1);
+    }
+    unvisited.append(true);
+    latest.push_back(-1);
+}
+
+void RecencyOrder::addSession(int slot) {
+    const int64_t session = static_cast<int64_t>(latestMarks.size());
+    if (slot < 0 || static_cast<size_t>(slot) >= latest.size()) {
+        latestMarks.append(false);
+        return;
+    }
+
+    if (latest[slot] >= 0) latestMarks.add(static_cast<size_t>(latest[slot]), -1);
+    else unvisited.add(static_cast<size_t>(slot), -1);
+
+    latestMarks.append(true);
+    latest[slot] = session;
+}
+
+// Row 0 is the newest mark, so count marks from the end
+size_t RecencyOrder::latestSessionAt(size_t row) const {
+    return latestMarks.select(latestMarks.total() - 1 - row);
+}
+
+int RecencyOrder::unvisitedAt(size_t row) const {
+    return static_cast<int>(unvisited.select(row - visitedCount()));
+}
+
+size_t RecencyOrder::rowOf(int slot) const {
+    if (slot < 0 || static_cast<size_t>(slot) >= latest.size()) return size();
+    if (latest[slot] >= 0) {
+        return latestMarks.total() - latestMarks.prefix(static_cast<size_t>(latest[slot]) + 1);
+    }
+    return visitedCount() + unvisited.prefix(static_cast<size_t>(slot));
+}
@@ -0,0 +1,58 @@
+#ifndef RECENCYORDER_H
+#define RECENCYORDER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// ================= LAST-VISIT ORDER =================
+// Patient slots by their latest session, most recent first, followed by
+// every patient who has no session yet, in registration order.
+//
+// Sessions are numbered in the order they are added. One Fenwick tree
+// over those numbers marks each patient's latest session, another over
+// slots marks the patients not seen yet. A visit just moves one mark, and
+// the k-th mark is found by walking down the tree, so addSession(), the
+// row lookups and rowOf() are all O(log n).
+//
+// A row of the visited part resolves to a session number; the caller maps
+// it back to the patient through its session storage.
+class RecencyOrder
+{
+public:
+    void addPatient(int slot);       // slots must be added in increasing order
+    void addSession(int slot);       // the next session, by its patient's slot (-1 = no such patient)
+
+    size_t size() const { return unvisited.size(); }
+    size_t visitedCount() const { return latestMarks.total(); }
+
+    // For row < visitedCount(): the session number shown at that row
+    size_t latestSessionAt(size_t row) const;
+    // For row >= visitedCount(): the slot shown at that row
+    int unvisitedAt(size_t row) const;
+
+    size_t rowOf(int slot) const;
+
+private:
+    // Fenwick tree of 0/1 marks that can grow at the end
+    class Marks
+    {
+    public:
+        void append(bool marked);
+        void add(size_t i, int delta);       // mark (+1) or unmark (-1) element i
+        size_t prefix(size_t count) const;   // marks among the first `count` elements
+        size_t select(size_t k) const;       // index of the k-th mark, 0-based
+        size_t size() const { return tree.size(); }
+        size_t total() const { return marked; }
+
+    private:
+        std::vector<uint32_t> tree;   // tree[i - 1] covers (i - lowbit(i), i]
+        size_t marked = 0;
+    };
+
+    Marks latestMarks;             // session number -> is some patient's latest
+    Marks unvisited;               // slot -> has no session yet
+    std::vector<int64_t> latest;   // slot -> session number of its latest session (-1 = none)
+};
+
+#endif // RECENCYORDER_H
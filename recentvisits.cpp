@@ -0,0 +1,34 @@
+#include "recentvisits.h"
+
+RecentVisits::RecentVisits(size_t capacity)
+    : ring(capacity > 0 ? capacity : 1) {}
+
+void RecentVisits::touch(int patientID) {
+    // Already in the list: close the gap it leaves and move it to the front
+    for (size_t i = 0; i < count; ++i) {
+        if (ring[physical(i)] != patientID) continue;
+
+        for (size_t j = i; j > 0; --j) {
+            ring[physical(j)] = ring[physical(j - 1)];
+        }
+        ring[head] = patientID;
+        return;
+    }
+
+    // New entry: step head back one; when full this reuses the oldest slot
+    head = (head + ring.size() - 1) % ring.size();
+    ring[head] = patientID;
+    if (count < ring.size()) count++;
+}
+
+void RecentVisits::setCapacity(size_t capacity) {
+    if (capacity == 0) capacity = 1;
+
+    std::vector<int> resized(capacity);
+    size_t kept = count < capacity ? count : capacity;
+    for (size_t i = 0; i < kept; ++i) resized[i] = at(i);
+
+    ring.swap(resized);
+    head = 0;
+    count = kept;
+}
@@ -0,0 +1,32 @@
+#ifndef RECENTVISITS_H
+#define RECENTVISITS_H
+
+#include <cstddef>
+#include <vector>
+
+// ================= RECENTLY VISITED (RING BUFFER) =================
+// Fixed-capacity circular buffer of patient IDs with LRU semantics:
+// a patient who comes back moves to the front instead of being stored
+// twice, and once full the least recent entry is overwritten. Nothing is
+// allocated after construction (or setCapacity()).
+class RecentVisits
+{
+public:
+    explicit RecentVisits(size_t capacity);
+
+    void touch(int patientID);             // record a visit
+    void setCapacity(size_t capacity);     // keeps the most recent entries that still fit
+
+    size_t capacity() const { return ring.size(); }
+    size_t size() const { return count; }
+    int at(size_t i) const { return ring[physical(i)]; }   // 0 = most recent
+
+private:
+    size_t physical(size_t i) const { return (head + i) % ring.size(); }
+
+    std::vector<int> ring;
+    size_t head = 0;     // physical index of the most recent entry
+    size_t count = 0;
+};
+
+#endif // RECENTVISITS_H
@@ -0,0 +1,100 @@
+#include "recordingstore.h"
+#include <QCryptographicHash>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QTemporaryFile>
+#include <QStandardPaths>
+#include <vector>
+
+// Large reads keep the disk streaming; 4 MiB is past the point where
+// bigger chunks stop helping
+static const qint64 CHUNK_SIZE = 4 * 1024 * 1024;
+
+RecordingStore::RecordingStore(const QString& rootDir)
+    : root(rootDir)
+{
+}
+
+QString RecordingStore::defaultRoot()
+{
+    return QDir(QStandardPaths::writableLocation(QStandardPaths::AppDataLocation)).filePath("recordings");
+}
+
+QString RecordingStore::pathFor(const QString& hash) const
+{
+    return QDir(root).filePath(hash.left(2) + "/" + hash.mid(2));
+}
+
+bool RecordingStore::contains(const QString& hash) const
+{
+    return hash.size() == 64 && QFile::exists(pathFor(hash));
+}
+
+IngestResult RecordingStore::ingest(const QString& sourcePath, IngestProgress* progress) const
+{
+    IngestResult result;
+    QElapsedTimer timer;
+    timer.start();
+
+    QFile source(sourcePath);
+    if (!source.open(QIODevice::ReadOnly)) {
+        result.error = "Cannot read " + sourcePath;
+        return result;
+    }
+    if (progress) progress->bytesTotal = source.size();
+
+    // Copy into a temporary file first: the name is only known once the
+    // whole recording has been hashed
+    QDir().mkpath(root);
+    QTemporaryFile copy(QDir(root).filePath("incoming-XXXXXX"));   // removed unless kept below
+    if (!copy.open()) {
+        result.error = "Cannot write to " + root;
+        return result;
+    }
+
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+    std::vector<char> buffer(CHUNK_SIZE);
+    for (;;) {
+        if (progress && progress->cancelled.load(std::memory_order_relaxed)) {
+            result.error = "Cancelled";
+            return result;
+        }
+
+        qint64 n = source.read(buffer.data(), CHUNK_SIZE);
+        if (n < 0) {
+            result.error = "Read failed: " + source.errorString();
+            return result;
+        }
+        if (n == 0) break;
+
+        hash.addData(QByteArray::fromRawData(buffer.data(), static_cast<int>(n)));
+        if (copy.write(buffer.data(), n) != n) {
+            result.error = "Write failed: " + copy.errorString();
+            return result;
+        }
+        result.bytes += n;
+        if (progress) progress->bytesDone = result.bytes;
+    }
+
+    result.hash = QString::fromLatin1(hash.result().toHex());
+    const QString target = pathFor(result.hash);
+
+    if (QFile::exists(target)) {
+        // Same content already stored: keep the existing copy
+        result.duplicate = true;
+    } else {
+        QDir().mkpath(QFileInfo(target).absolutePath());
+        if (!copy.flush() || !copy.rename(target)) {
+            result.error = "Could not store the recording in " + root;
+            return result;
+        }
+        copy.setAutoRemove(false);   // it is the stored recording now
+    }
+
+    const qint64 ms = qMax<qint64>(1, timer.elapsed());
+    result.mibPerSecond = (result.bytes / (1024.0 * 1024.0)) / (ms / 1000.0);
+    result.ok = true;
+    return result;
+}
@@ -0,0 +1,51 @@
+#ifndef RECORDINGSTORE_H
+#define RECORDINGSTORE_H
+
+#include <QString>
+#include <QtGlobal>
+#include <atomic>
+
+// ================= RECORDING STORE =================
+// Session recordings stored by content: a file lives at
+// <root>/<first two hex digits of its SHA-256>/<remaining digits>, so the
+// same recording uploaded twice is kept once. Sessions refer to a
+// recording by its hash.
+//
+// ingest() streams the source in large chunks, hashing while it copies,
+// and can take minutes for multi-GB files: run it on a worker thread and
+// watch `progress` from the GUI thread.
+
+// Shared between the ingesting thread (writes) and the UI (reads)
+struct IngestProgress {
+    std::atomic<qint64> bytesDone{0};
+    std::atomic<qint64> bytesTotal{0};
+    std::atomic<bool> cancelled{false};
+};
+
+struct IngestResult {
+    bool ok = false;
+    QString error;
+    QString hash;            // lowercase hex SHA-256
+    qint64 bytes = 0;
+    bool duplicate = false;  // already in the store; nothing new was kept
+    double mibPerSecond = 0.0;
+};
+
+class RecordingStore
+{
+public:
+    explicit RecordingStore(const QString& rootDir = defaultRoot());
+
+    // <AppData>/recordings
+    static QString defaultRoot();
+
+    IngestResult ingest(const QString& sourcePath, IngestProgress* progress = nullptr) const;
+
+    QString pathFor(const QString& hash) const;
+    bool contains(const QString& hash) const;
+
+private:
+    QString root;
+};
+
+#endif // RECORDINGSTORE_H
@@ -0,0 +1,319 @@
+// Backend snapshot save/load (declared in backend.h).
+//
+// File layout, version 4 (all arrays 8-byte aligned, see snapshotio.h):
+//   header         magic "ECSNAP01", version, byte-order mark,
+//                  next patient/session IDs, patient and session counts
+//   patients       PatientRecord[]  + string heap (name|gender|birth_date)
+//   patientSlots   dense ID -> slot table
+//   nameIndex      packed folded names + trigram posting lists
+//   visitRanking   ranking arrays
+//   sessions       SessionRecord[]  + string heap (date|notes|recording_hash)
+//   notesIndex     vocabulary + compressed posting lists
+//   nameOrder      slots in A-Z order
+//   end marker
+//
+// Only the current version loads; any other is treated like a missing
+// snapshot and the journal is replayed instead.
+//
+// Indexes are stored prebuilt and copied straight out of the mapping,
+// after checking that every slot they refer to exists, so a damaged file
+// fails to load instead of indexing out of range later.
+// Sessions are relinked into their chains while they are materialized,
+// which also rebuilds the last-visit order.
+
+#include "backend.h"
+#include "mappedfile.h"
+#include "snapshotio.h"
+#include "trace.h"
+#include <algorithm>
+#include <cstdio>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+const char SNAPSHOT_MAGIC[8] = {'E', 'C', 'S', 'N', 'A', 'P', '0', '1'};
+const uint32_t SNAPSHOT_VERSION = 4;
+const uint32_t BYTE_ORDER_MARK = 0x01020304;
+const uint64_t END_MARKER = 0x444E455041534345ull;   // "ECSAPEND"
+
+struct SnapshotHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrder;
+    int32_t nextPatientID;
+    int32_t nextSessionID;
+    uint64_t patientCount;
+    uint64_t sessionCount;
+};
+
+struct PatientRecord {
+    int32_t id;
+    int32_t visitCount;
+    uint64_t textOffset;    // name, gender, birth_date back to back
+    uint32_t nameLength;
+    uint32_t genderLength;
+    uint32_t birthDateLength;
+    uint32_t reserved;
+};
+
+struct SessionRecord {
+    int32_t sessionID;
+    int32_t patientID;
+    uint64_t textOffset;    // date, notes, recording hash back to back
+    uint32_t dateLength;
+    uint32_t notesLength;
+    uint32_t recordingLength;
+    uint32_t reserved;
+};
+
+// Make a rename into `path`'s directory durable. The CRT offers no way to
+// flush a directory on Windows, so there it is left to the file system.
+bool syncParentDirectory(const std::string& path) {
+#ifdef _WIN32
+    (void)path;
+    return true;
+#else
+    const size_t slash = path.find_last_of('/');
+    const std::string dir = slash == std::string::npos ? "." : path.substr(0, slash == 0 ? 1 : slash);
+    const int fd = ::open(dir.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return false;
+    const bool ok = ::fsync(fd) == 0;
+    ::close(fd);
+    return ok;
+#endif
+}
+
+} // namespace
+
+// ================= SAVE =================
+
+bool Backend::saveSnapshot(const std::string& path) const {
+    TRACE_SPAN("backend", "saveSnapshot");
+    std::shared_lock<std::shared_mutex> lock(patientMutex);
+
+    const std::string tempPath = path + ".tmp";
+    SnapshotWriter out;
+    if (!out.open(tempPath)) return false;
+
+    SnapshotHeader header = {};
+    std::copy(SNAPSHOT_MAGIC, SNAPSHOT_MAGIC + 8, header.magic);
+    header.version = SNAPSHOT_VERSION;
+    header.byteOrder = BYTE_ORDER_MARK;
+    header.nextPatientID = globalPatientID;
+    header.nextSessionID = globalSessionID;
+    header.patientCount = allPatients.size();
+    header.sessionCount = sessionArena.size();
+    out.value(header);
+
+    // === Patients ===
+    std::vector<PatientRecord> patientRecords;
+    patientRecords.reserve(allPatients.size());
+    std::string patientText;
+    for (const Patient& p : allPatients) {
+        PatientRecord r = {};
+        r.id = p.id;
+        r.visitCount = p.visit_count;
+        r.textOffset = patientText.size();
+        r.nameLength = static_cast<uint32_t>(p.name.size());
+        r.genderLength = static_cast<uint32_t>(p.gender.size());
+        r.birthDateLength = static_cast<uint32_t>(p.birth_date.size());
+        patientText += p.name;
+        patientText += p.gender;
+        patientText += p.birth_date;
+        patientRecords.push_back(r);
+    }
+    out.array(patientRecords);
+    out.array(patientText);
+
+    // === Prebuilt indexes ===
+    out.array(patientSlots);
+    nameIndex.save(out);
+    visitRanking.save(out);
+
+    // === Sessions, written a chunk at a time to keep the buffers small ===
+    out.value<uint64_t>(sessionArena.chunkCount());
+    for (size_t c = 0; c < sessionArena.chunkCount(); ++c) {
+        const SessionNode* nodes = sessionArena.chunkData(c);
+        const size_t count = sessionArena.chunkLength(c);
+
+        std::vector<SessionRecord> sessionRecords(count);
+        std::string sessionText;
+        for (size_t i = 0; i < count; ++i) {
+            const Session& s = nodes[i].data;
+            SessionRecord& r = sessionRecords[i];
+            r.sessionID = s.session_id;
+            r.patientID = s.patientID;
+            r.textOffset = sessionText.size();
+            r.dateLength = static_cast<uint32_t>(s.date.size());
+            r.notesLength = static_cast<uint32_t>(s.notes.size());
+            r.recordingLength = static_cast<uint32_t>(s.recording_hash.size());
+            sessionText += s.date;
+            sessionText += s.notes;
+            sessionText += s.recording_hash;
+        }
+        out.array(sessionRecords);
+        out.array(sessionText);
+    }
+
+    notesIndex.save(out);
+    nameOrder.save(out);
+    out.value(END_MARKER);
+    if (!out.finish()) {
+        std::remove(tempPath.c_str());
+        return false;
+    }
+
+    // Replace the old snapshot only once the new one is complete and on disk
+#ifdef _WIN32
+    std::remove(path.c_str());
+#endif
+    return std::rename(tempPath.c_str(), path.c_str()) == 0 && syncParentDirectory(path);
+}
+
+// ================= LOAD =================
+
+bool Backend::loadSnapshot(const std::string& path) {
+    TRACE_SPAN("backend", "loadSnapshot");
+    if (!allPatients.empty() || !sessionArena.empty()) return false;   // only into an empty backend
+
+    MappedFile file;
+    if (!file.open(path)) return false;
+    file.adviseSequential();
+
+    SnapshotReader in(file.data(), file.size());
+    SnapshotHeader header;
+    if (!in.value(header) ||
+        !std::equal(SNAPSHOT_MAGIC, SNAPSHOT_MAGIC + 8, header.magic) ||
+        header.version != SNAPSHOT_VERSION || header.byteOrder != BYTE_ORDER_MARK) {
+        return false;
+    }
+
+    std::unique_lock<std::shared_mutex> lock(patientMutex);
+
+    bool loaded = [&]() {
+        // === Patients ===
+        size_t patientTotal = 0, textSize = 0;
+        const PatientRecord* patientRecords = in.view<PatientRecord>(patientTotal);
+        const char* patientText = in.view<char>(textSize);
+        if (!in.ok() || patientTotal != header.patientCount) return false;
+
+        for (size_t i = 0; i < patientTotal; ++i) {
+            const PatientRecord& r = patientRecords[i];
+            uint64_t textLength = uint64_t(r.nameLength) + r.genderLength + r.birthDateLength;
+            if (r.textOffset > textSize || textLength > textSize - r.textOffset) return false;
+
+            const char* text = patientText + r.textOffset;
+            Patient p;
+            p.id = r.id;
+            p.name.assign(text, r.nameLength);
+            p.gender.assign(text + r.nameLength, r.genderLength);
+            p.birth_date.assign(text + r.nameLength + r.genderLength, r.birthDateLength);
+            p.visit_count = r.visitCount;
+            allPatients.push_back(std::move(p));
+        }
+
+        // === Prebuilt indexes ===
+        if (!in.array(patientSlots) || !nameIndex.load(in, allPatients.size()) ||
+            !visitRanking.load(in, allPatients.size())) {
+            return false;
+        }
+        for (int slot : patientSlots) {
+            if (slot < -1 || slot >= static_cast<int>(allPatients.size())) return false;
+        }
+        for (size_t slot = 0; slot < allPatients.size(); ++slot) {
+            recencyOrder.addPatient(static_cast<int>(slot));
+        }
+
+        // === Sessions, relinked into the clinic list and patient chains ===
+        sessionChains.assign(allPatients.size(), SessionChain());
+
+        auto loadChunk = [&]() {
+            size_t count = 0, sessionTextSize = 0;
+            const SessionRecord* records = in.view<SessionRecord>(count);
+            const char* sessionText = in.view<char>(sessionTextSize);
+            if (!in.ok()) return false;
+
+            for (size_t i = 0; i < count; ++i) {
+                const SessionRecord& r = records[i];
+                uint64_t textLength = uint64_t(r.dateLength) + r.notesLength + r.recordingLength;
+                if (r.textOffset > sessionTextSize || textLength > sessionTextSize - r.textOffset) return false;
+
+                SessionNode& node = sessionArena.emplace_back();
+                const char* text = sessionText + r.textOffset;
+                node.data.session_id = r.sessionID;
+                node.data.patientID = r.patientID;
+                node.data.date.assign(text, r.dateLength);
+                node.data.notes.assign(text + r.dateLength, r.notesLength);
+                node.data.recording_hash.assign(text + r.dateLength + r.notesLength, r.recordingLength);
+                node.next = nullptr;
+                node.nextOfPatient = nullptr;
+
+                if (sessionTail) sessionTail->next = &node;
+                else sessionHead = &node;
+                sessionTail = &node;
+
+                int slot = (r.patientID >= 0 && r.patientID < static_cast<int>(patientSlots.size()))
+                               ? patientSlots[r.patientID] : -1;
+                recencyOrder.addSession(slot);
+                if (slot < 0) continue;
+
+                SessionChain& chain = sessionChains[slot];
+                if (!chain.last) chain.first = &node;
+                else chain.last->nextOfPatient = &node;
+                chain.last = &node;
+                chain.count++;
+            }
+            return true;
+        };
+
+        uint64_t chunkTotal = 0;
+        if (!in.value(chunkTotal)) return false;
+        for (uint64_t c = 0; c < chunkTotal; ++c) {
+            if (!loadChunk()) return false;
+        }
+
+        // === Notes index and name order ===
+        if (!notesIndex.load(in) || notesIndex.documentCount() != sessionArena.size()) return false;
+        if (!nameOrder.load(in, nameIndex)) return false;
+
+        uint64_t endMarker = 0;
+        if (!in.value(endMarker) || endMarker != END_MARKER || sessionArena.size() != header.sessionCount) {
+            return false;
+        }
+
+        globalPatientID = header.nextPatientID;
+        globalSessionID = header.nextSessionID;
+        revisionCount++;
+        return true;
+    }();
+
+    // Never leave a half-loaded backend behind
+    if (!loaded) {
+        allPatients.clear();
+        patientSlots.clear();
+        nameIndex = NameIndex();
+        visitRanking = VisitRanking();
+        notesIndex = NotesIndex();
+        nameOrder = NameOrder();
+        recencyOrder = RecencyOrder();
+        sessionArena = ChunkedArena<SessionNode>();
+        sessionChains.clear();
+        sessionHead = sessionTail = nullptr;
+    }
+    return loaded;
+}
+
+// ================= CHECKPOINT =================
+
+// Snapshot, then empty the journal. saveSnapshot() returns only once the
+// new file and its rename are on disk, so a crash before the reset leaves
+// both; replay then skips records the snapshot already holds.
+bool Backend::checkpoint(const std::string& snapshotPath) {
+    TRACE_SPAN("backend", "checkpoint");
+    if (!saveSnapshot(snapshotPath)) return false;
+    return !journal || journal->reset();
+}
@@ -0,0 +1,144 @@
+#ifndef SNAPSHOTIO_H
+#define SNAPSHOTIO_H
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+// ================= SNAPSHOT STREAMS =================
+// Snapshot files are a flat sequence of plain values and arrays. Every
+// array starts on an 8-byte boundary, so once the file is memory-mapped
+// an array can be used in place through SnapshotReader::view().
+// Values are stored in host byte order; the header records which.
+
+class SnapshotWriter
+{
+public:
+    ~SnapshotWriter() { if (file) std::fclose(file); }
+
+    bool open(const std::string& path) {
+        file = std::fopen(path.c_str(), "wb");
+        if (file) std::setvbuf(file, nullptr, _IOFBF, 1 << 20);
+        good = file != nullptr;
+        return good;
+    }
+
+    // Flush, force to disk and close; false if anything failed along the way
+    bool finish() {
+        if (!file) return false;
+        good = std::fflush(file) == 0 && good;
+#ifdef _WIN32
+        good = _commit(_fileno(file)) == 0 && good;
+#else
+        good = ::fsync(fileno(file)) == 0 && good;
+#endif
+        good = std::fclose(file) == 0 && good;
+        file = nullptr;
+        return good;
+    }
+
+    bool ok() const { return good; }
+
+    void bytes(const void* data, size_t size) {
+        if (!good || size == 0) return;
+        good = std::fwrite(data, 1, size, file) == size;
+        written += size;
+    }
+
+    template <typename T>
+    void value(const T& v) {
+        static_assert(std::is_trivially_copyable<T>::value, "plain values only");
+        bytes(&v, sizeof(T));
+    }
+
+    // u64 count, padding to 8, then the elements
+    template <typename T>
+    void array(const T* data, size_t count) {
+        static_assert(std::is_trivially_copyable<T>::value, "plain values only");
+        value<uint64_t>(count);
+        bytes(data, count * sizeof(T));
+        pad();
+    }
+
+    template <typename T>
+    void array(const std::vector<T>& v) { array(v.data(), v.size()); }
+
+    void array(const std::string& s) { array(s.data(), s.size()); }
+
+private:
+    void pad() {
+        static const char zeros[8] = {};
+        if (written % 8) bytes(zeros, 8 - written % 8);
+    }
+
+    std::FILE* file = nullptr;
+    uint64_t written = 0;
+    bool good = false;
+};
+
+class SnapshotReader
+{
+public:
+    SnapshotReader(const char* data, size_t size) : data(data), size(size) {}
+
+    bool ok() const { return good; }
+
+    template <typename T>
+    bool value(T& v) {
+        static_assert(std::is_trivially_copyable<T>::value, "plain values only");
+        if (!good || size - pos < sizeof(T)) return good = false;
+        std::memcpy(&v, data + pos, sizeof(T));
+        pos += sizeof(T);
+        return true;
+    }
+
+    // Zero-copy access to the next array: points into the mapped file
+    template <typename T>
+    const T* view(size_t& count) {
+        uint64_t n = 0;
+        count = 0;
+        if (!value(n)) return nullptr;
+        if (n > (size - pos) / sizeof(T)) { good = false; return nullptr; }
+
+        const T* first = reinterpret_cast<const T*>(data + pos);
+        pos += n * sizeof(T);
+        if (pos % 8) pos += 8 - pos % 8;
+        if (pos > size) { good = false; return nullptr; }
+        count = static_cast<size_t>(n);
+        return first;
+    }
+
+    template <typename T>
+    bool array(std::vector<T>& out) {
+        size_t count = 0;
+        const T* first = view<T>(count);
+        if (!good) return false;
+        out.assign(first, first + count);
+        return true;
+    }
+
+    bool array(std::string& out) {
+        size_t count = 0;
+        const char* first = view<char>(count);
+        if (!good) return false;
+        out.assign(first, count);
+        return true;
+    }
+
+private:
+    const char* data;
+    size_t size;
+    size_t pos = 0;
+    bool good = true;
+};
+
+#endif // SNAPSHOTIO_H
@@ -0,0 +1,198 @@
+#include "stallwatchdog.h"
+#include <QTimer>
+#include <QStringList>
+#include <QtGlobal>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+
+// ================= EVENT-LOOP LATENCY =================
+
+const double LoopLatencyHistogram::BUCKET_LIMITS_MS[BUCKETS] = {
+    1, 2, 5, 10, 20, 50, 100, 200, 500, 1000, 5000, std::numeric_limits<double>::infinity()};
+
+void LoopLatencyHistogram::record(double ms, qint64 nowSeconds)
+{
+    const qint64 index = nowSeconds / PERIOD_SECONDS;
+    Period& period = periods[index % PERIODS];
+    if (period.index != index) period = Period{index};
+
+    int bucket = 0;
+    while (ms > BUCKET_LIMITS_MS[bucket]) ++bucket;
+    period.counts[bucket]++;
+    period.maxMs = std::max(period.maxMs, ms);
+}
+
+bool LoopLatencyHistogram::current(const Period& period, qint64 nowSeconds) const
+{
+    return period.index >= 0 && nowSeconds / PERIOD_SECONDS - period.index < PERIODS;
+}
+
+QVector<quint64> LoopLatencyHistogram::counts(qint64 nowSeconds) const
+{
+    QVector<quint64> totals(BUCKETS, 0);
+    for (const Period& period : periods) {
+        if (!current(period, nowSeconds)) continue;
+        for (int b = 0; b < BUCKETS; ++b) totals[b] += period.counts[b];
+    }
+    return totals;
+}
+
+double LoopLatencyHistogram::percentile(double q, qint64 nowSeconds) const
+{
+    const QVector<quint64> totals = counts(nowSeconds);
+    quint64 total = 0;
+    for (quint64 c : totals) total += c;
+    if (total == 0) return 0.0;
+
+    const quint64 rank = std::max<quint64>(1, static_cast<quint64>(std::ceil(q * total)));
+    quint64 seen = 0;
+    for (int b = 0; b < BUCKETS - 1; ++b) {
+        seen += totals[b];
+        if (seen >= rank) return BUCKET_LIMITS_MS[b];
+    }
+    return maxMs(nowSeconds);
+}
+
+double LoopLatencyHistogram::maxMs(qint64 nowSeconds) const
+{
+    double worst = 0;
+    for (const Period& period : periods) {
+        if (current(period, nowSeconds)) worst = std::max(worst, period.maxMs);
+    }
+    return worst;
+}
+
+// ================= STALL WATCHDOG =================
+
+StallWatchdog::StallWatchdog(int thresholdMs, int heartbeatIntervalMs, QObject* parent)
+    : QObject(parent), threshold(qMax(1, thresholdMs)), heartbeatMs(qMax(1, heartbeatIntervalMs))
+{
+    heartbeat = new QTimer(this);
+    heartbeat->setTimerType(Qt::PreciseTimer);
+    heartbeat->setInterval(heartbeatMs);
+    connect(heartbeat, &QTimer::timeout, this, &StallWatchdog::beat);
+}
+
+StallWatchdog::~StallWatchdog()
+{
+    stop();
+}
+
+void StallWatchdog::start()
+{
+    if (watcher.joinable()) return;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = false;
+    }
+    clock.start();
+    guiThread = tracing::currentThread();
+    tracing::trackOpenSpans(true);
+    lastBeatNs = clock.nsecsElapsed();
+    lastBeat.store(lastBeatNs, std::memory_order_release);
+
+    heartbeat->start();
+    watcher = std::thread(&StallWatchdog::watch, this);
+}
+
+void StallWatchdog::stop()
+{
+    heartbeat->stop();
+    tracing::trackOpenSpans(false);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    if (watcher.joinable()) watcher.join();
+}
+
+std::deque<Stall> StallWatchdog::stalls() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return stallLog;
+}
+
+// GUI thread: how late this beat is goes into the histogram, and a beat
+// after a stall closes it
+void StallWatchdog::beat()
+{
+    const qint64 now = clock.nsecsElapsed();
+    const double gapMs = (now - lastBeatNs) / 1e6;
+    lastBeatNs = now;
+    histogram.record(std::max(0.0, gapMs - heartbeatMs), now / 1000000000);
+
+    bool ended = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        const quint64 previous = beatCount.load(std::memory_order_relaxed);
+        if (gapMs >= threshold) {
+            if (reportedBeat == previous && !stallLog.empty() && stallLog.back().ongoing) {
+                stallLog.back().ms = gapMs;
+                stallLog.back().ongoing = false;
+                ended = true;
+            } else {
+                // Over before the watchdog looked, so nobody saw what ran
+                stallLog.push_back({QDateTime::currentDateTime().addMSecs(-static_cast<qint64>(gapMs)), gapMs,
+                                    QString("(ended before it was caught)"), false});
+                if (stallLog.size() > static_cast<size_t>(STALL_HISTORY)) stallLog.pop_front();
+            }
+        }
+        beatCount.store(previous + 1, std::memory_order_relaxed);
+        lastBeat.store(now, std::memory_order_relaxed);
+    }
+    if (ended) qWarning("Event loop stall ended after %.0f ms", gapMs);
+}
+
+// Watchdog thread: looks at the last beat a few times per threshold
+void StallWatchdog::watch()
+{
+    const auto poll = std::chrono::milliseconds(qMax(1, threshold / 4));
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!stopping) {
+        wake.wait_for(lock, poll, [this] { return stopping; });
+        if (stopping) break;
+
+        const quint64 beats = beatCount.load(std::memory_order_relaxed);
+        const double sinceMs = (clock.nsecsElapsed() - lastBeat.load(std::memory_order_relaxed)) / 1e6;
+        if (sinceMs < threshold) continue;
+
+        if (reportedBeat == beats && !stallLog.empty() && stallLog.back().ongoing) {
+            stallLog.back().ms = sinceMs;   // already logged; keep its length current
+            continue;
+        }
+
+        // Caught in the act: see what the GUI thread is inside
+        lock.unlock();
+        const QString running = describeRunning();
+        lock.lock();
+        if (stopping || beatCount.load(std::memory_order_relaxed) != beats) continue;   // it recovered meanwhile
+
+        stallLog.push_back({QDateTime::currentDateTime().addMSecs(-static_cast<qint64>(sinceMs)), sinceMs, running,
+                            true});
+        if (stallLog.size() > static_cast<size_t>(STALL_HISTORY)) stallLog.pop_front();
+        reportedBeat = beats;
+
+        lock.unlock();
+        qWarning("Event loop stalled for %.0f ms in: %s", sinceMs, qPrintable(running));
+        lock.lock();
+    }
+}
+
+// "ui DashboardWindow::refreshRecent (212 ms) > backend getRecentVisits (3 ms)"
+QString StallWatchdog::describeRunning() const
+{
+    if (!tracing::enabled()) return "unknown: tracing is off (ESPRITCARE_TRACE=0)";
+
+    const std::vector<tracing::OpenSpan> spans = tracing::openSpans(guiThread);
+    if (spans.empty()) return "no traced slot or backend call";
+
+    QStringList parts;
+    for (const tracing::OpenSpan& span : spans) {
+        parts << QString("%1 %2 (%3 ms)").arg(span.category, span.name).arg(span.ms, 0, 'f', 0);
+    }
+    return parts.join(" > ");
+}
@@ -0,0 +1,112 @@
+#pragma once
+#include <QObject>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QString>
+#include <QVector>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include "trace.h"
+
+class QTimer;
+
+// One time the event loop stopped answering for longer than the threshold
+struct Stall {
+    QDateTime when;
+    double ms;         // how long the loop was blocked (so far, while ongoing)
+    QString running;   // open spans on the GUI thread when it was caught
+    bool ongoing;
+};
+
+// ================= EVENT-LOOP LATENCY =================
+// How late the GUI thread's heartbeat timer fired, bucketed by upper bound
+// in ms, over a rolling window of PERIODS x PERIOD_SECONDS
+class LoopLatencyHistogram
+{
+public:
+    static const int BUCKETS = 12;
+    static const double BUCKET_LIMITS_MS[BUCKETS];   // last one is unbounded
+    static const int PERIODS = 60;
+    static const int PERIOD_SECONDS = 5;
+
+    void record(double ms, qint64 nowSeconds);
+
+    // Totals over the window, as of nowSeconds
+    QVector<quint64> counts(qint64 nowSeconds) const;
+    double percentile(double q, qint64 nowSeconds) const;   // bucket upper bound
+    double maxMs(qint64 nowSeconds) const;
+
+private:
+    struct Period {
+        qint64 index = -1;   // which PERIOD_SECONDS period the counts are for
+        quint64 counts[BUCKETS] = {};
+        double maxMs = 0;
+    };
+    bool current(const Period& period, qint64 nowSeconds) const;
+
+    Period periods[PERIODS];
+};
+
+// ================= STALL WATCHDOG =================
+// Heartbeats the GUI event loop and reports when it stops answering.
+//
+// A timer on the GUI thread beats every heartbeatMs; how late each beat
+// fires goes into the latency histogram. A watchdog thread checks the last
+// beat and, once it is older than thresholdMs, logs a warning naming the
+// slot or backend call the GUI thread is inside (its open trace spans, see
+// trace.h) with how long each has been running. The stall's full length is
+// filled in when the loop beats again.
+//
+// Modal dialogs run a nested event loop and keep beating, so they do not
+// count as stalls; the work done while they are open still can.
+class StallWatchdog : public QObject
+{
+    Q_OBJECT
+public:
+    explicit StallWatchdog(int thresholdMs = 50, int heartbeatMs = 10, QObject* parent = nullptr);
+    ~StallWatchdog() override;
+
+    // Starts watching the calling thread, which must run the event loop,
+    // and has it track its open trace spans (tracing::trackOpenSpans)
+    void start();
+
+    // Stops the heartbeat and the watchdog thread. Call it on the same
+    // thread as soon as the event loop returns: nothing beats after that,
+    // so shutdown work would be reported as a stall. The destructor calls
+    // it too.
+    void stop();
+
+    int thresholdMs() const { return threshold; }
+    const LoopLatencyHistogram& latency() const { return histogram; }
+    qint64 nowSeconds() const { return clock.elapsed() / 1000; }
+
+    // Most recent stalls, oldest first (at most STALL_HISTORY)
+    std::deque<Stall> stalls() const;
+    static const int STALL_HISTORY = 100;
+
+private:
+    void beat();
+    void watch();
+    QString describeRunning() const;
+
+    const int threshold;
+    const int heartbeatMs;
+    QTimer* heartbeat;
+    QElapsedTimer clock;            // shared by both threads; read-only after start()
+    LoopLatencyHistogram histogram;   // GUI thread only
+    qint64 lastBeatNs = 0;            // GUI thread only
+
+    std::atomic<qint64> lastBeat{0};      // clock ns of the latest beat
+    std::atomic<quint64> beatCount{0};
+    tracing::ThreadId guiThread = nullptr;
+
+    mutable std::mutex mutex;   // guards stallLog, reportedBeat and stopping
+    std::condition_variable wake;
+    std::deque<Stall> stallLog;
+    quint64 reportedBeat = 0;    // beat after which the ongoing stall was logged
+    bool stopping = false;
+    std::thread watcher;
+};
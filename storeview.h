@@ -0,0 +1,28 @@
+#ifndef STOREVIEW_H
+#define STOREVIEW_H
+
+#include <cstddef>
+
+// ================= NON-OWNING RANGE =================
+// A begin/end pair over data owned by someone else (usually Backend).
+// Walking it copies nothing; it is only valid while the owner is alive,
+// and only until the owner's next mutation on the GUI thread.
+template <typename Iterator>
+class Range
+{
+public:
+    Range(Iterator first, Iterator last, size_t count)
+        : first(first), last(last), count(count) {}
+
+    Iterator begin() const { return first; }
+    Iterator end() const { return last; }
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+
+private:
+    Iterator first;
+    Iterator last;
+    size_t count;
+};
+
+#endif // STOREVIEW_H
@@ -0,0 +1,72 @@
+// RecordingStore::ingest() must leave the recording in the store once it
+// returns, both for new content and for a duplicate of stored content.
+//
+// Registered with CTest; run `ctest` from the build directory.
+
+#include "recordingstore.h"
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QTemporaryDir>
+#include <cstdio>
+
+static int failures = 0;
+
+static void check(bool condition, const char* what)
+{
+    if (!condition) {
+        std::fprintf(stderr, "FAILED: %s\n", what);
+        failures++;
+    }
+}
+
+static QByteArray readAll(const QString& path)
+{
+    QFile file(path);
+    return file.open(QIODevice::ReadOnly) ? file.readAll() : QByteArray();
+}
+
+int main(int argc, char* argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    QTemporaryDir dir;
+    if (!dir.isValid()) {
+        std::fprintf(stderr, "cannot create a temporary directory\n");
+        return 1;
+    }
+
+    // A few chunks' worth, so the copy loop runs more than once
+    QByteArray content;
+    for (int i = 0; content.size() < 9 * 1024 * 1024; ++i) content += QByteArray::number(i) + ' ';
+    const QString sourcePath = dir.filePath("session.wav");
+    {
+        QFile source(sourcePath);
+        check(source.open(QIODevice::WriteOnly) && source.write(content) == content.size(), "write the source file");
+    }
+
+    RecordingStore store(dir.filePath("recordings"));
+
+    // === New content ===
+    const IngestResult first = store.ingest(sourcePath);
+    check(first.ok, "first ingest succeeds");
+    check(!first.duplicate, "first ingest is not a duplicate");
+    check(first.bytes == content.size(), "first ingest copies every byte");
+    check(first.hash.size() == 64, "hash is 64 hex digits");
+    check(QFile::exists(store.pathFor(first.hash)), "stored file exists after ingest() returns");
+    check(store.contains(first.hash), "store contains the hash");
+    check(readAll(store.pathFor(first.hash)) == content, "stored file has the source content");
+
+    // === Same content again ===
+    const IngestResult second = store.ingest(sourcePath);
+    check(second.ok && second.duplicate, "second ingest is a duplicate");
+    check(second.hash == first.hash, "second ingest has the same hash");
+    check(QFile::exists(store.pathFor(first.hash)), "stored file still exists after the duplicate");
+
+    // Nothing is left behind from the temporary copies
+    const QStringList leftovers = QDir(dir.filePath("recordings")).entryList({"incoming-*"}, QDir::Files);
+    check(leftovers.isEmpty(), "no incoming-* temporary files remain");
+
+    if (failures == 0) std::printf("recordingstore_test: all checks passed\n");
+    return failures == 0 ? 0 : 1;
+}
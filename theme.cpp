@@ -0,0 +1,262 @@
+#include "theme.h"
+#include <QApplication>
+#include <QStyle>
+#include <QWidget>
+
+namespace Theme
+{
+
+// Colours: ink #1f2f45, muted #4a5e72 / #6b7c8c, lines #cfd9e6,
+// accent #2b7de9, danger #dc3545, sidebar #203040
+const QString& styleSheet()
+{
+    static const QString sheet = QStringLiteral(R"(
+        /* ---------- Screens ---------- */
+        #screen {
+            background: qlineargradient(spread:pad, x1:0, y1:0, x2:1, y2:1,
+                        stop:0 #f3f7fc, stop:1 #d6e6f5);
+        }
+
+        QFrame#card {
+            background-color: #ffffff;
+            border: 1px solid #cfd9e6;
+            border-radius: 12px;
+        }
+
+        QFrame#separator {
+            color: #cfd9e6;
+        }
+        #card QFrame#separator {
+            margin: 20px 0;
+        }
+
+        /* ---------- Text ---------- */
+        #appTitle {
+            color: #1f2f45;
+        }
+        #tagline {
+            color: #4a5e72;
+        }
+        #title {
+            font-size: 24px;
+            font-weight: bold;
+            color: #1f2f45;
+            margin-bottom: 10px;
+        }
+        #bannerTitle {
+            font-size: 24px;
+            font-weight: bold;
+            color: #1f2f45;
+            background-color: rgba(255, 255, 255, 0.6);
+            border-radius: 8px;
+            padding: 10px 15px;
+        }
+        #greeting {
+            font-size: 26px;
+            font-weight: bold;
+            color: #1f2f45;
+        }
+        #dateTime {
+            font-size: 11pt;
+            color: #4a5e72;
+        }
+        #sectionTitle {
+            font-size: 12pt;
+            font-weight: bold;
+            color: #1f2f45;
+        }
+        #fieldLabel {
+            font-size: 11pt;
+            color: #1f2f45;
+            font-weight: 500;
+            margin-bottom: 6px;
+        }
+
+        /* Status lines under a field: idle (grey), found (blue), missing (red) */
+        #statusLabel {
+            color: #6b7c8c;
+            font-size: 10pt;
+            margin-top: 5px;
+        }
+        #statusLabel[state="found"] {
+            color: #2b7de9;
+            font-weight: 500;
+        }
+        #statusLabel[state="missing"] {
+            color: #dc3545;
+            font-weight: 500;
+        }
+
+        /* ---------- Form inputs ---------- */
+        #card QLineEdit, #card QComboBox, #card QSpinBox, #card QDateEdit, #card QTextEdit {
+            padding: 10px 12px;
+            border: 1px solid #cfd9e6;
+            border-radius: 6px;
+            font-size: 11pt;
+            background-color: #ffffff;
+            color: #1f2f45;
+        }
+        #card QLineEdit:focus, #card QComboBox:focus, #card QSpinBox:focus,
+        #card QDateEdit:focus, #card QTextEdit:focus {
+            border: 1px solid #2b7de9;
+            background-color: #f8fafc;
+        }
+
+        QLineEdit#searchBox {
+            padding: 8px 12px;
+            border: 1px solid #cfd9e6;
+            border-radius: 6px;
+            font-size: 11pt;
+            color: #1f2f45;
+            background-color: rgba(255, 255, 255, 0.8);
+        }
+        QLineEdit#searchBox:focus {
+            border: 1px solid #2b7de9;
+            background-color: #f8fafc;
+        }
+        QComboBox#sortCombo {
+            padding: 6px 10px;
+            border: 1px solid #cfd9e6;
+            border-radius: 6px;
+            font-size: 10.5pt;
+            background-color: rgba(255, 255, 255, 0.8);
+        }
+
+        /* ---------- Buttons ---------- */
+        QPushButton#primaryButton {
+            background-color: #2b7de9;
+            color: white;
+            border: none;
+            border-radius: 6px;
+            padding: 0 24px;
+            font-size: 11pt;
+            font-weight: 500;
+        }
+        QPushButton#primaryButton:hover {
+            background-color: #256dd1;
+        }
+        QPushButton#primaryButton[compact="true"] {
+            padding: 8px 16px;
+            font-size: 10.5pt;
+        }
+        QPushButton#secondaryButton {
+            background-color: #e8ecef;
+            color: #1f2f45;
+            border: none;
+            border-radius: 6px;
+            padding: 0 24px;
+            font-size: 11pt;
+            font-weight: 500;
+        }
+        QPushButton#secondaryButton:hover {
+            background-color: #d6dce2;
+        }
+        QPushButton#getStartedButton {
+            background-color: #2b7de9;
+            color: white;
+            font-size: 13pt;
+            font-weight: bold;
+            border-radius: 8px;
+            padding: 8px 16px;
+            border: none;
+        }
+        QPushButton#getStartedButton:hover {
+            background-color: #358af0;
+        }
+        QPushButton#getStartedButton:pressed {
+            background-color: #266bcc;
+        }
+
+        /* ---------- Dashboard side menu ---------- */
+        QFrame#sidePanel {
+            background-color: #203040;
+            border-top-right-radius: 16px;
+            border-bottom-right-radius: 16px;
+        }
+        #sidePanel QPushButton {
+            background-color: transparent;
+            color: white;
+            border: none;
+            text-align: left;
+            padding: 10px 20px;
+            font-size: 11pt;
+        }
+        #sidePanel QPushButton:hover {
+            background-color: #2b7de9;
+            border-radius: 6px;
+        }
+        #menuTitle {
+            color: white;
+            font-weight: bold;
+            font-size: 14pt;
+        }
+
+        /* ---------- Lists and tables ---------- */
+        QListWidget#dashboardList {
+            background: #ffffff;
+            border: 1px solid #cfd9e6;
+            border-radius: 8px;
+        }
+        QListWidget#suggestionList {
+            background: #ffffff;
+            border: 1px solid #cfd9e6;
+            border-radius: 6px;
+            font-size: 10.5pt;
+            color: #1f2f45;
+        }
+        QListWidget#suggestionList::item {
+            padding: 4px 8px;
+        }
+        QListWidget#suggestionList::item:hover {
+            background-color: #f0f5fc;
+        }
+
+        QTableView#patientTable {
+            background-color: rgba(255, 255, 255, 0.85);
+            border: 1px solid #cfd9e6;
+            border-radius: 8px;
+            gridline-color: #e1e8ef;
+            font-size: 10.5pt;
+            color: #1f2f45;
+        }
+        QTableView#patientTable::item {
+            padding: 6px;
+        }
+        #patientTable QHeaderView::section {
+            background-color: rgba(255, 255, 255, 0.7);
+            padding: 8px;
+            font-weight: 600;
+            color: #1f2f45;
+            border: none;
+        }
+
+        QProgressBar#recordingProgress {
+            background-color: #e8ecef;
+            border: none;
+            border-radius: 3px;
+        }
+        QProgressBar#recordingProgress::chunk {
+            background-color: #2b7de9;
+            border-radius: 3px;
+        }
+    )");
+    return sheet;
+}
+
+void apply(QApplication& app)
+{
+    app.setStyleSheet(styleSheet());
+}
+
+// Re-polishing one widget re-matches its rules from the already parsed sheet
+void setState(QWidget* widget, const char* state)
+{
+    if (widget->property("state").toByteArray() == state) return;
+
+    widget->setProperty("state", state);
+    widget->style()->unpolish(widget);
+    widget->style()->polish(widget);
+    widget->update();
+}
+
+} // namespace Theme
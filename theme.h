@@ -0,0 +1,22 @@
+#pragma once
+#include <QString>
+
+class QApplication;
+class QWidget;
+
+// ================= THEME =================
+// The whole look of the app as one stylesheet, set once on the
+// QApplication at startup, so Qt parses it a single time. Widgets pick
+// their look by object name (setObjectName("primaryButton")) instead of
+// carrying their own setStyleSheet() strings.
+//
+// Looks that change at run time (a status label turning blue or red) are
+// a "state" property matched by the stylesheet; setState() flips it and
+// re-polishes the one widget without parsing any CSS.
+namespace Theme
+{
+    void apply(QApplication& app);
+    const QString& styleSheet();
+
+    void setState(QWidget* widget, const char* state);
+}
@@ -0,0 +1,311 @@
+#include "trace.h"
+#include <algorithm>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace tracing {
+
+namespace detail {
+std::atomic<bool> on{false};
+std::atomic<int> trackingThreads{0};
+} // namespace detail
+
+namespace {
+
+// Counters are marked in the top bit of the timestamp, which ticks never
+// reach, keeping an event at 32 bytes: two to a cache line
+const uint64_t COUNTER_BIT = uint64_t(1) << 63;
+
+// Fields are relaxed atomics so a dump may read a slot while its thread
+// overwrites it; the dump then discards that slot (see snapshot())
+struct Event {
+    std::atomic<const char*> category{nullptr};
+    std::atomic<const char*> name{nullptr};
+    std::atomic<uint64_t> start{0};
+    std::atomic<int64_t> value{0};   // duration in ticks for spans
+};
+
+struct Copy {
+    const char* category;
+    const char* name;
+    uint64_t start;
+    int64_t value;
+};
+
+// One per thread that has recorded anything. Only that thread writes;
+// `head` counts every event ever written, so slot = index % capacity.
+struct ThreadRing {
+    explicit ThreadRing(int tid) : tid(tid), events(new Event[RING_CAPACITY]) {}
+
+    void push(const char* category, const char* name, uint64_t start, int64_t value)
+    {
+        const uint64_t index = head.load(std::memory_order_relaxed);
+        Event& e = events[index % RING_CAPACITY];
+        e.category.store(category, std::memory_order_relaxed);
+        e.name.store(name, std::memory_order_relaxed);
+        e.start.store(start, std::memory_order_relaxed);
+        e.value.store(value, std::memory_order_relaxed);
+        head.store(index + 1, std::memory_order_release);
+    }
+
+    // The events that were not overwritten while being copied
+    std::vector<Copy> snapshot() const
+    {
+        const uint64_t end = head.load(std::memory_order_acquire);
+        const uint64_t begin = end > RING_CAPACITY ? end - RING_CAPACITY : 0;
+        std::vector<Copy> copies;
+        copies.reserve(end - begin);
+        for (uint64_t i = begin; i < end; ++i) {
+            const Event& e = events[i % RING_CAPACITY];
+            copies.push_back({e.category.load(std::memory_order_relaxed), e.name.load(std::memory_order_relaxed),
+                              e.start.load(std::memory_order_relaxed), e.value.load(std::memory_order_relaxed)});
+        }
+        // The writer may be filling slot `after` right now, which is the
+        // slot of event after - capacity
+        std::atomic_thread_fence(std::memory_order_acquire);
+        const uint64_t after = head.load(std::memory_order_relaxed);
+        const uint64_t firstIntact = after >= RING_CAPACITY ? after - RING_CAPACITY + 1 : 0;
+        if (firstIntact > begin) {
+            copies.erase(copies.begin(), copies.begin() + std::min<uint64_t>(firstIntact - begin, copies.size()));
+        }
+        return copies;
+    }
+
+    // Spans entered and not yet recorded, for openSpans(), kept only while
+    // the owner tracks them. Only the owner writes; depth keeps counting
+    // past MAX_OPEN_SPANS so exits balance.
+    struct Open {
+        std::atomic<const char*> category{nullptr};
+        std::atomic<const char*> name{nullptr};
+        std::atomic<uint64_t> start{0};
+    };
+    Open open[MAX_OPEN_SPANS];
+    std::atomic<int> openDepth{0};
+    bool trackingOpen = false;   // owner only
+
+    const int tid;
+    std::atomic<const char*> name{nullptr};
+    std::atomic<uint64_t> head{0};
+    std::unique_ptr<Event[]> events;
+};
+
+// Rings outlive their threads, so a dump still shows work done by a
+// thread that has since finished. When a thread exits its ring goes on
+// freeRings and the next new thread records into it, keeping the old
+// events until they are overwritten; pools that keep retiring and
+// starting threads then reuse a handful of rings instead of adding one
+// per thread.
+std::mutex registryMutex;   // guards rings and freeRings
+std::vector<std::unique_ptr<ThreadRing>> rings;
+std::vector<ThreadRing*> freeRings;
+
+thread_local ThreadRing* currentRing = nullptr;
+
+// Called by the owner, or for it once it has exited
+void stopTracking(ThreadRing* r)
+{
+    if (!r->trackingOpen) return;
+    r->trackingOpen = false;
+    r->openDepth.store(0, std::memory_order_release);
+    detail::trackingThreads.fetch_sub(1, std::memory_order_relaxed);
+}
+
+// Hands the thread's ring back when the thread exits. Kept apart from
+// currentRing so the hot path reads a plain pointer with no TLS guard.
+struct RingOwner {
+    ThreadRing* owned = nullptr;
+    ~RingOwner()
+    {
+        if (!owned) return;
+        stopTracking(owned);
+        currentRing = nullptr;
+        std::lock_guard<std::mutex> lock(registryMutex);
+        freeRings.push_back(owned);
+    }
+};
+thread_local RingOwner ringOwner;
+
+ThreadRing* ring()
+{
+    if (!currentRing) {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        if (!freeRings.empty()) {
+            currentRing = freeRings.back();
+            freeRings.pop_back();
+            currentRing->name.store(nullptr, std::memory_order_relaxed);
+        } else {
+            rings.push_back(std::make_unique<ThreadRing>(static_cast<int>(rings.size()) + 1));
+            currentRing = rings.back().get();
+        }
+        ringOwner.owned = currentRing;
+    }
+    return currentRing;
+}
+
+// Literals from our own code, but a stray quote must not break the file
+void writeString(std::FILE* out, const char* text)
+{
+    std::fputc('"', out);
+    for (const char* c = text ? text : ""; *c; ++c) {
+        if (*c == '"' || *c == '\\') std::fputc('\\', out);
+        if (static_cast<unsigned char>(*c) >= 0x20) std::fputc(*c, out);
+    }
+    std::fputc('"', out);
+}
+
+// Ticks to nanoseconds, measured against steady_clock over the life of
+// the process. Current x86 CPUs keep one constant-rate TSC for all cores.
+const uint64_t startTick = detail::now();
+const std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+
+double nanosecondsPerTick()
+{
+#if defined(ESPRITCARE_TRACE_TSC)
+    const uint64_t ticks = detail::now() - startTick;
+    const double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - startTime).count();
+    return ticks ? ns / ticks : 1.0;
+#else
+    return 1e9 * std::chrono::steady_clock::period::num / std::chrono::steady_clock::period::den;
+#endif
+}
+
+} // namespace
+
+namespace detail {
+
+// Only reached while some thread tracks its open spans; the others return
+// straight away
+bool enterSpan(const char* category, const char* name, uint64_t start)
+{
+    ThreadRing* r = ring();
+    if (!r->trackingOpen) return false;
+    const int depth = r->openDepth.load(std::memory_order_relaxed);
+    if (depth < MAX_OPEN_SPANS) {
+        r->open[depth].category.store(category, std::memory_order_relaxed);
+        r->open[depth].name.store(name, std::memory_order_relaxed);
+        r->open[depth].start.store(start, std::memory_order_relaxed);
+    }
+    r->openDepth.store(depth + 1, std::memory_order_release);
+    return true;
+}
+
+void recordSpan(const char* category, const char* name, uint64_t start, uint64_t end, bool tracked)
+{
+    ThreadRing* r = ring();
+    r->push(category, name, start, static_cast<int64_t>(end - start));
+    if (!tracked) return;
+    const int depth = r->openDepth.load(std::memory_order_relaxed);
+    if (depth > 0) r->openDepth.store(depth - 1, std::memory_order_release);
+}
+
+void recordCounter(const char* category, const char* name, int64_t value)
+{
+    ring()->push(category, name, now() | COUNTER_BIT, value);
+}
+
+} // namespace detail
+
+void setEnabled(bool enable)
+{
+    detail::on.store(enable, std::memory_order_relaxed);
+}
+
+void setThreadName(const char* name)
+{
+    ring()->name.store(name, std::memory_order_relaxed);
+}
+
+ThreadId currentThread()
+{
+    return ring();
+}
+
+// Spans already open when tracking starts are not on the stack; their
+// exits leave it alone because they were not tracked
+void trackOpenSpans(bool track)
+{
+    ThreadRing* r = ring();
+    if (!track) {
+        stopTracking(r);
+    } else if (!r->trackingOpen) {
+        r->trackingOpen = true;
+        detail::trackingThreads.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+std::vector<OpenSpan> openSpans(ThreadId thread)
+{
+    std::vector<OpenSpan> spans;
+    const ThreadRing* r = static_cast<const ThreadRing*>(thread);
+    if (!r || !enabled()) return spans;
+
+    const int depth = std::min(r->openDepth.load(std::memory_order_acquire), MAX_OPEN_SPANS);
+    const uint64_t current = detail::now();
+    const double msPerTick = nanosecondsPerTick() / 1e6;
+    for (int i = 0; i < depth; ++i) {
+        const uint64_t start = r->open[i].start.load(std::memory_order_relaxed);
+        spans.push_back({r->open[i].category.load(std::memory_order_relaxed),
+                         r->open[i].name.load(std::memory_order_relaxed),
+                         current > start ? (current - start) * msPerTick : 0.0});
+    }
+    return spans;
+}
+
+bool writeChromeTrace(const std::string& path)
+{
+    std::vector<std::pair<const ThreadRing*, std::vector<Copy>>> threads;
+    {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        for (const auto& r : rings) threads.emplace_back(r.get(), r->snapshot());
+    }
+
+    // Timestamps are made relative to the oldest event kept
+    const double usPerTick = nanosecondsPerTick() / 1000;
+    uint64_t origin = UINT64_MAX;
+    for (const auto& t : threads) {
+        for (const Copy& c : t.second) origin = std::min(origin, c.start & ~COUNTER_BIT);
+    }
+
+    std::FILE* out = std::fopen(path.c_str(), "w");
+    if (!out) return false;
+
+    std::fprintf(out, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n");
+    bool first = true;
+    auto separator = [&]() {
+        if (!first) std::fprintf(out, ",\n");
+        first = false;
+    };
+    for (const auto& t : threads) {
+        const int tid = t.first->tid;
+        if (const char* threadName = t.first->name.load(std::memory_order_relaxed)) {
+            separator();
+            std::fprintf(out, "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": %d, \"args\": {\"name\": ",
+                         tid);
+            writeString(out, threadName);
+            std::fprintf(out, "}}");
+        }
+        for (const Copy& c : t.second) {
+            separator();
+            std::fprintf(out, "{\"name\": ");
+            writeString(out, c.name);
+            std::fprintf(out, ", \"cat\": ");
+            writeString(out, c.category);
+            const double ts = ((c.start & ~COUNTER_BIT) - origin) * usPerTick;
+            if (c.start & COUNTER_BIT) {
+                std::fprintf(out, ", \"ph\": \"C\", \"ts\": %.3f, \"pid\": 1, \"tid\": %d, \"args\": {\"value\": %lld}}",
+                             ts, tid, static_cast<long long>(c.value));
+            } else {
+                std::fprintf(out, ", \"ph\": \"X\", \"ts\": %.3f, \"dur\": %.3f, \"pid\": 1, \"tid\": %d}", ts,
+                             c.value * usPerTick, tid);
+            }
+        }
+    }
+    std::fprintf(out, "\n]}\n");
+
+    const bool ok = !std::ferror(out);
+    return std::fclose(out) == 0 && ok;
+}
+
+} // namespace tracing
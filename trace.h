@@ -0,0 +1,139 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define ESPRITCARE_TRACE_TSC
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#define ESPRITCARE_TRACE_TSC
+#endif
+
+// ================= TRACING =================
+// Scoped spans and counters around backend and screen work, so a report
+// like "it froze after saving" comes with data. Each thread records into
+// its own fixed-size ring without taking a lock; when a ring is full
+// the newest events overwrite the oldest. writeChromeTrace() dumps every
+// ring as Chrome trace_event JSON, for chrome://tracing or ui.perfetto.dev.
+//
+//   Session Backend::addSession(...)
+//   {
+//       TRACE_SPAN("backend", "addSession");
+//       ...
+//   }
+//
+// Recording is off until setEnabled(true); while off, a span costs one
+// relaxed load and a branch, and building with ESPRITCARE_NO_TRACING
+// removes it altogether. While on, a span costs two time-stamp reads and
+// one 32-byte write to the ring, plus keeping its thread's open spans
+// current if that thread called trackOpenSpans(true).
+// Categories and names must be string literals: only the pointer is kept.
+
+namespace tracing {
+
+namespace detail {
+extern std::atomic<bool> on;
+extern std::atomic<int> trackingThreads;   // threads with trackOpenSpans(true)
+
+// Timestamps in ticks: the CPU's time-stamp counter on x86, which costs a
+// fraction of a steady_clock read, otherwise steady_clock nanoseconds.
+// writeChromeTrace() converts ticks to time.
+inline uint64_t now()
+{
+#if defined(ESPRITCARE_TRACE_TSC)
+    return __rdtsc();
+#else
+    return static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+}
+
+bool enterSpan(const char* category, const char* name, uint64_t start);   // true if tracked
+void recordSpan(const char* category, const char* name, uint64_t start, uint64_t end, bool tracked);
+void recordCounter(const char* category, const char* name, int64_t value);
+} // namespace detail
+
+inline bool enabled() { return detail::on.load(std::memory_order_relaxed); }
+void setEnabled(bool enable);
+
+// Label for the calling thread in the viewer (a string literal)
+void setThreadName(const char* name);
+
+// A sampled value over time, e.g. queue depth, drawn as a graph
+inline void counter(const char* category, const char* name, int64_t value)
+{
+    if (enabled()) detail::recordCounter(category, name, value);
+}
+
+// A span that has started and not yet ended
+struct OpenSpan {
+    const char* category;
+    const char* name;
+    double ms;   // how long it has been running
+};
+
+// Handle to a recording thread, for looking at it from another thread.
+// Valid while that thread runs; once it exits, a later thread may take
+// over its ring and the handle.
+using ThreadId = const void*;
+ThreadId currentThread();
+
+// Keep the calling thread's open spans current for openSpans(). Off by
+// default because it adds to every span on that thread; StallWatchdog
+// turns it on for the thread it watches.
+void trackOpenSpans(bool track);
+
+// What `thread` is inside right now, outermost first (at most
+// MAX_OPEN_SPANS deep). Read without stopping the thread, so a span that
+// ends meanwhile may still be listed. Empty while recording is off or
+// the thread does not track its open spans.
+std::vector<OpenSpan> openSpans(ThreadId thread);
+const int MAX_OPEN_SPANS = 16;
+
+// Everything still held in the rings, oldest first per thread. Safe to
+// call while other threads keep recording; false if `path` can't be written.
+bool writeChromeTrace(const std::string& path);
+
+// Events each thread keeps before overwriting the oldest
+const size_t RING_CAPACITY = 1 << 15;
+
+class Span
+{
+public:
+    Span(const char* category, const char* name)
+        : category(category), name(name), start(enabled() ? detail::now() : 0),
+          tracked(start && detail::trackingThreads.load(std::memory_order_relaxed) > 0 &&
+                  detail::enterSpan(category, name, start)) {}
+    ~Span()
+    {
+        if (start) detail::recordSpan(category, name, start, detail::now(), tracked);
+    }
+
+    Span(const Span&) = delete;
+    Span& operator=(const Span&) = delete;
+
+private:
+    const char* category;
+    const char* name;
+    uint64_t start;   // 0 = tracing was off when the span opened
+    bool tracked;     // on its thread's open-span stack
+};
+
+} // namespace tracing
+
+#define TRACE_JOIN2(a, b) a##b
+#define TRACE_JOIN(a, b) TRACE_JOIN2(a, b)
+
+#if defined(ESPRITCARE_NO_TRACING)
+#define TRACE_SPAN(category, name) ((void)0)
+#define TRACE_COUNTER(category, name, value) ((void)0)
+#else
+#define TRACE_SPAN(category, name) ::tracing::Span TRACE_JOIN(traceSpan_, __LINE__)(category, name)
+#define TRACE_COUNTER(category, name, value) ::tracing::counter(category, name, value)
+#endif
+
+#endif // TRACE_H
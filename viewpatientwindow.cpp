@@ -1,5 +1,8 @@
 #include "viewpatientwindow.h"
-#include "dashboardwindow.h"
+#include "navigator.h"
+#include "patienttablemodel.h"
+#include "backendsignals.h"
+#include "trace.h"
 
 #include <QVBoxLayout>
 #include <QHBoxLayout>
@@ -7,24 +10,20 @@
 #include <QFrame>
 #include <QMessageBox>
 
-ViewPatientWindow::ViewPatientWindow(QWidget *parent)
-    : QMainWindow(parent)
+ViewPatientWindow::ViewPatientWindow(Backend* backendPtr, Navigator* navigatorPtr, QWidget *parent)
+    : QMainWindow(parent), backend(backendPtr), navigator(navigatorPtr)
 {
     setupUi();
 }
 
 void ViewPatientWindow::setupUi()
 {
+    TRACE_SPAN("ui", "ViewPatientWindow::setupUi");
     QWidget *central = new QWidget(this);
     setCentralWidget(central);
 
     // --- Background Gradient (Matches Theme) ---
-    central->setStyleSheet(R"(
-        QWidget {
-            background: qlineargradient(spread:pad, x1:0, y1:0, x2:1, y2:1,
-                        stop:0 #f3f7fc, stop:1 #d6e6f5);
-        }
-    )");
+    central->setObjectName("screen");
 
     QVBoxLayout *mainLayout = new QVBoxLayout(central);
     mainLayout->setAlignment(Qt::AlignTop);
@@ -33,14 +32,7 @@ void ViewPatientWindow::setupUi()
 
     // --- Title ---
     QLabel *titleLabel = new QLabel("View Patients");
-    titleLabel->setStyleSheet(R"(
-        font-size: 24px;
-        font-weight: bold;
-        color: #1f2f45;
-        background-color: rgba(255, 255, 255, 0.6);
-        border-radius: 8px;
-        padding: 10px 15px;
-    )");
+    titleLabel->setObjectName("bannerTitle");
     mainLayout->addWidget(titleLabel);
 
     // --- Search and Sort Section ---
@@ -49,50 +41,18 @@ void ViewPatientWindow::setupUi()
     searchEdit = new QLineEdit;
     searchEdit->setPlaceholderText("Search by patient name or ID...");
     searchEdit->setFixedHeight(38);
-    searchEdit->setStyleSheet(R"(
-        QLineEdit {
-            padding: 8px 12px;
-            border: 1px solid #cfd9e6;
-            border-radius: 6px;
-            font-size: 11pt;
-            color: #1f2f45;
-            background-color: rgba(255, 255, 255, 0.8);
-        }
-        QLineEdit:focus {
-            border: 1px solid #2b7de9;
-            background-color: #f8fafc;
-        }
-    )");
+    searchEdit->setObjectName("searchBox");
 
     searchBtn = new QPushButton("Search");
     searchBtn->setFixedSize(100, 38);
-    searchBtn->setStyleSheet(R"(
-        QPushButton {
-            background-color: #2b7de9;
-            color: white;
-            border: none;
-            border-radius: 6px;
-            font-size: 10.5pt;
-            font-weight: 500;
-        }
-        QPushButton:hover {
-            background-color: #256dd1;
-        }
-    )");
+    searchBtn->setObjectName("primaryButton");
+    searchBtn->setProperty("compact", true);
 
     sortCombo = new QComboBox;
     sortCombo->addItem("Sort by Name (A–Z)");
     sortCombo->addItem("Sort by Most Recent Visit");
     sortCombo->setFixedHeight(38);
-    sortCombo->setStyleSheet(R"(
-        QComboBox {
-            padding: 6px 10px;
-            border: 1px solid #cfd9e6;
-            border-radius: 6px;
-            font-size: 10.5pt;
-            background-color: rgba(255, 255, 255, 0.8);
-        }
-    )");
+    sortCombo->setObjectName("sortCombo");
 
     searchLayout->addWidget(searchEdit);
     searchLayout->addWidget(searchBtn);
@@ -101,80 +61,83 @@ void ViewPatientWindow::setupUi()
 
     mainLayout->addLayout(searchLayout);
 
-    // --- Table Section (Empty for now) ---
-    patientTable = new QTableWidget(0, 4);
-    patientTable->setHorizontalHeaderLabels({"Patient ID", "Name", "Age", "Last Visit"});
+    // --- Table Section ---
+    // Rows come straight from the backend through the model, a batch at a
+    // time as the user scrolls. Fixed row heights keep the view from
+    // measuring every row, so opening the screen does not depend on the
+    // number of patients.
+    patientModel = new PatientTableModel(backend, this);
+    patientTable = new QTableView;
+    patientTable->setModel(patientModel);
+    patientTable->setSelectionBehavior(QAbstractItemView::SelectRows);
+    patientTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    patientTable->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+    patientTable->verticalHeader()->setDefaultSectionSize(34);
     patientTable->horizontalHeader()->setStretchLastSection(true);
     patientTable->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
-    patientTable->setStyleSheet(R"(
-        QHeaderView::section {
-            background-color: rgba(255, 255, 255, 0.7);
-            padding: 8px;
-            font-weight: 600;
-            color: #1f2f45;
-            border: none;
-        }
-        QTableWidget {
-            background-color: rgba(255, 255, 255, 0.85);
-            border: 1px solid #cfd9e6;
-            border-radius: 8px;
-            gridline-color: #e1e8ef;
-            font-size: 10.5pt;
-            color: #1f2f45;
-        }
-        QTableWidget::item {
-            padding: 6px;
-        }
-    )");
+    patientTable->setObjectName("patientTable");
     mainLayout->addWidget(patientTable);
 
     // --- Back Button ---
     QHBoxLayout *bottomLayout = new QHBoxLayout;
     backBtn = new QPushButton("Back to Dashboard");
     backBtn->setFixedHeight(42);
-    backBtn->setStyleSheet(R"(
-        QPushButton {
-            background-color: #e8ecef;
-            color: #1f2f45;
-            border: none;
-            border-radius: 6px;
-            padding: 0 24px;
-            font-size: 11pt;
-            font-weight: 500;
-        }
-        QPushButton:hover {
-            background-color: #d6dce2;
-        }
-    )");
+    backBtn->setObjectName("secondaryButton");
     bottomLayout->addStretch();
     bottomLayout->addWidget(backBtn);
     mainLayout->addLayout(bottomLayout);
 
     // --- Connections ---
     connect(searchBtn, &QPushButton::clicked, this, &ViewPatientWindow::onSearchClicked);
+    connect(searchEdit, &QLineEdit::returnPressed, this, &ViewPatientWindow::onSearchClicked);
+    connect(sortCombo, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &ViewPatientWindow::onSortChanged);
     connect(backBtn, &QPushButton::clicked, this, &ViewPatientWindow::onBackClicked);
+    connect(navigator->changes(), &BackendSignals::patientsAdded, patientModel, &PatientTableModel::onPatientsAdded);
+    connect(navigator->changes(), &BackendSignals::sessionAdded, patientModel, &PatientTableModel::onSessionAdded);
 
     // Window setup
     setWindowTitle("EspritCare - View Patients");
     resize(900, 600);
 }
 
-// --- Search Placeholder Function ---
+// --- Search: matches by ID or name; an empty query lists everyone again ---
 void ViewPatientWindow::onSearchClicked()
 {
+    TRACE_SPAN("ui", "ViewPatientWindow::onSearchClicked");
     QString query = searchEdit->text().trimmed();
     if (query.isEmpty()) {
-        QMessageBox::information(this, "Search", "Please enter a patient name or ID to search.");
-    } else {
-        QMessageBox::information(this, "Search", "Search feature coming soon!");
+        patientModel->showAll();
+        return;
     }
+
+    std::vector<Patient*> matches = backend->searchPatients(query.toStdString());
+    if (matches.empty()) {
+        QMessageBox::information(this, "Search", "No patient matches \"" + query + "\".");
+        return;
+    }
+    patientModel->showMatches(std::move(matches));
+}
+
+// --- Sort: both orders are kept up to date by the backend ---
+void ViewPatientWindow::onSortChanged(int index)
+{
+    TRACE_SPAN("ui", "ViewPatientWindow::onSortChanged");
+    patientModel->setOrder(index == 1 ? PatientOrder::RecentVisit : PatientOrder::Name);
+    patientTable->scrollToTop();
 }
 
 // --- Back Button ---
 void ViewPatientWindow::onBackClicked()
 {
-    auto *dashboard = new DashboardWindow();
-    dashboard->show();
-    this->close();
+    navigator->go(Screen::Dashboard);
+}
+
+// The model only re-reads the rows on screen, so this is cheap at any size
+void ViewPatientWindow::resetForm()
+{
+    TRACE_SPAN("ui", "ViewPatientWindow::resetForm");
+    searchEdit->clear();
+    patientModel->showAll();
+    patientTable->scrollToTop();
 }
 
@@ -6,17 +6,23 @@
 #include <QPushButton>
 #include <QComboBox>
 #include <QLabel>
-#include <QTableWidget>
+#include <QTableView>
+#include "backend.h"
+
+class PatientTableModel;
+class Navigator;
 
 class ViewPatientWindow : public QMainWindow
 {
     Q_OBJECT
 
 public:
-    explicit ViewPatientWindow(QWidget *parent = nullptr);
+    explicit ViewPatientWindow(Backend* backendPtr, Navigator* navigatorPtr, QWidget *parent = nullptr);
+    void resetForm();   // clear the search and list everyone again
 
 private slots:
     void onSearchClicked();
+    void onSortChanged(int index);
     void onBackClicked();
 
 private:
@@ -25,8 +31,11 @@ private:
     QLineEdit *searchEdit;
     QPushButton *searchBtn;
     QComboBox *sortCombo;
-    QTableWidget *patientTable;
+    QTableView *patientTable;
+    PatientTableModel *patientModel;
     QPushButton *backBtn;
+    Backend* backend;
+    Navigator* navigator;
 };
 
 #endif // VIEWPATIENTWINDOW_H
@@ -0,0 +1,68 @@
+#include "visitranking.h"
+#include "snapshotio.h"
+#include <utility>
+
+void VisitRanking::add(int slot) {
+    if (slot >= static_cast<int>(counts.size())) {
+        counts.resize(slot + 1, 0);
+        rankOf.resize(slot + 1, 0);
+    }
+
+    // Zero-visit patients sit at the very end; open that bucket if needed
+    bool zeroBucketEmpty = order.empty() || counts[order.back()] != 0;
+    if (bucketStart.empty()) bucketStart.push_back(0);
+    if (zeroBucketEmpty) bucketStart[0] = order.size();
+
+    counts[slot] = 0;
+    rankOf[slot] = order.size();
+    order.push_back(slot);
+}
+
+void VisitRanking::increment(int slot) {
+    const int count = counts[slot];
+    const size_t front = bucketStart[count];
+
+    // Swap to the front of the bucket, then move the boundary past it
+    const size_t rank = rankOf[slot];
+    std::swap(order[rank], order[front]);
+    rankOf[order[rank]] = rank;
+    rankOf[slot] = front;
+
+    // The slot now ends the (count + 1) bucket, opening it if it was empty
+    bool higherBucketEmpty = front == 0 || counts[order[front - 1]] != count + 1;
+    if (static_cast<size_t>(count + 1) >= bucketStart.size()) {
+        bucketStart.resize(count + 2, 0);
+    }
+    if (higherBucketEmpty) bucketStart[count + 1] = front;
+
+    bucketStart[count] = front + 1;
+    counts[slot] = count + 1;
+}
+
+// ================= SNAPSHOT =================
+
+void VisitRanking::save(SnapshotWriter& out) const {
+    out.array(order);
+    out.array(rankOf);
+    out.array(counts);
+    out.array(bucketStart);
+}
+
+bool VisitRanking::load(SnapshotReader& in, size_t slotCount) {
+    if (!in.array(order) || !in.array(rankOf) || !in.array(counts) || !in.array(bucketStart)) return false;
+    if (order.size() != slotCount || rankOf.size() != slotCount || counts.size() != slotCount) return false;
+
+    // Every slot once, most visits first, each bucket starting where
+    // bucketStart says: increment() indexes all three without checking
+    for (size_t rank = 0; rank < order.size(); ++rank) {
+        const int slot = order[rank];
+        if (slot < 0 || static_cast<size_t>(slot) >= slotCount || rankOf[slot] != rank) return false;
+
+        const int count = counts[slot];
+        if (count < 0 || static_cast<size_t>(count) >= bucketStart.size()) return false;
+        const bool firstOfBucket = rank == 0 || counts[order[rank - 1]] != count;
+        if (rank > 0 && counts[order[rank - 1]] < count) return false;
+        if (firstOfBucket && bucketStart[count] != rank) return false;
+    }
+    return true;
+}
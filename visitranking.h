@@ -0,0 +1,39 @@
+#ifndef VISITRANKING_H
+#define VISITRANKING_H
+
+#include <cstddef>
+#include <vector>
+
+class SnapshotWriter;
+class SnapshotReader;
+
+// ================= VISIT COUNT RANKING =================
+// Patient slots kept ordered by visit count, most visits first.
+//
+// Slots with the same count form one contiguous bucket, and bucketStart
+// remembers where each bucket begins. A visit swaps the patient to the
+// front of its bucket and moves the bucket boundary by one, so both
+// add() and increment() are O(1) and the top k are simply the first k.
+class VisitRanking
+{
+public:
+    void add(int slot);           // new patient, zero visits
+    void increment(int slot);     // one more visit for this patient
+
+    size_t size() const { return order.size(); }
+    int slotAt(size_t rank) const { return order[rank]; }       // rank 0 = most visits
+    int countAt(size_t rank) const { return counts[order[rank]]; }
+
+    // Prebuilt ranking in/out of a snapshot; load() checks it is a
+    // consistent ranking of exactly `slotCount` slots
+    void save(SnapshotWriter& out) const;
+    bool load(SnapshotReader& in, size_t slotCount);
+
+private:
+    std::vector<int> order;            // slots, most visits first
+    std::vector<size_t> rankOf;        // slot -> position in order
+    std::vector<int> counts;           // slot -> visit count
+    std::vector<size_t> bucketStart;   // visit count -> first rank with that count
+};
+
+#endif // VISITRANKING_H